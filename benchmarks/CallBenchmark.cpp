@@ -0,0 +1,119 @@
+#include "benchmark.hpp"
+#include "any_facade.hpp"
+#include <vector>
+
+namespace af = any_facade;
+
+namespace
+{
+    struct Shape
+    {
+        virtual ~Shape() {}
+        virtual int sides() const = 0;
+    };
+
+    // not the first base of interfaces<>, so member pointers need 'this' adjusting
+    struct Scaled
+    {
+        virtual ~Scaled() {}
+        virtual int scale(int factor) const = 0;
+    };
+
+    struct Square { int size; };
+    struct Triangle { int size; };
+
+    int sidesOf(const Square&) { return 4; }
+    int sidesOf(const Triangle&) { return 3; }
+
+    typedef af::any<af::interfaces<Shape, Scaled>, af::not_comparable> Any;
+}
+
+namespace any_facade
+{
+    template <>
+    class forwarder<Any>
+    {
+    public:
+        int scale(int factor) const
+        {
+            return static_cast<const Any*>(this)->content->scale(factor);
+        }
+    };
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual int sides() const { return sidesOf(static_cast<const Derived*>(this)->held); }
+        virtual int scale(int factor) const { return static_cast<const Derived*>(this)->held.size * factor; }
+    };
+}
+
+namespace benchmarks
+{
+    // kept out of line so 'make check' can find them in the object file
+    __attribute__((noinline, used)) int forwarded_scale(const Any& a, int factor)
+    {
+        return a.scale(factor);
+    }
+
+    __attribute__((noinline, used)) int template_call_scale(const Any& a, int factor)
+    {
+        return a.call<&Scaled::scale>(factor);
+    }
+
+    void call_benchmarks()
+    {
+        const std::size_t count = 1000;
+        std::vector<Any> shapes;
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            if( i % 2 ) shapes.push_back(Any(Square{static_cast<int>(i)}));
+            else        shapes.push_back(Any(Triangle{static_cast<int>(i)}));
+        }
+
+        measure("forwarder a.scale(x)", 10000, count, [&shapes]()
+        {
+            long total = 0;
+            for( std::size_t i = 0; i < shapes.size(); ++i )
+            {
+                total += shapes[i].scale(2);
+            }
+            sink = sink + total;
+        });
+
+        int (Scaled::*fn)(int) const = &Scaled::scale;
+        measure("a.call(&Scaled::scale, x)", 10000, count, [&shapes, fn]()
+        {
+            long total = 0;
+            for( std::size_t i = 0; i < shapes.size(); ++i )
+            {
+                total += shapes[i].call(fn, 2);
+            }
+            sink = sink + total;
+        });
+
+        // the member pointer isn't known at compile time, e.g. chosen by the caller
+        volatile bool useScale = true;
+        int (Scaled::*chosen)(int) const = useScale ? &Scaled::scale : 0;
+        measure("a.call(fn, x) with a runtime member pointer", 10000, count, [&shapes, chosen]()
+        {
+            long total = 0;
+            for( std::size_t i = 0; i < shapes.size(); ++i )
+            {
+                total += shapes[i].call(chosen, 2);
+            }
+            sink = sink + total;
+        });
+
+        measure("a.call<&Scaled::scale>(x)", 10000, count, [&shapes]()
+        {
+            long total = 0;
+            for( std::size_t i = 0; i < shapes.size(); ++i )
+            {
+                total += shapes[i].call<&Scaled::scale>(2);
+            }
+            sink = sink + total;
+        });
+    }
+}
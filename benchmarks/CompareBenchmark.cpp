@@ -0,0 +1,103 @@
+#include "benchmark.hpp"
+#include "any_facade.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace af = any_facade;
+
+namespace
+{
+    struct Keyed
+    {
+        virtual ~Keyed() {}
+        virtual int key() const = 0;
+    };
+
+    // type_ordered, so sort_anys can sort each type on its own
+    typedef af::any<af::interfaces<Keyed>, af::type_ordered<af::less_than_equals_comparable> > Any;
+}
+
+namespace any_facade
+{
+    template <>
+    class forwarder<Any>
+    {
+    public:
+        int key() const
+        {
+            return static_cast<const Any*>(this)->content->key();
+        }
+    };
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual int key() const { return static_cast<int>(static_cast<const Derived*>(this)->held); }
+    };
+}
+
+namespace benchmarks
+{
+    // times only; 'make check' looks at the generated code to see that the
+    // same type comparisons don't make any calls
+    void compare_benchmarks()
+    {
+        const std::size_t count = 1000;
+        std::vector<Any> values;
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            values.push_back(Any(static_cast<int>((i * 7919) % count)));
+        }
+
+        measure("same type a == b", 10000, count, [&values]()
+        {
+            long total = 0;
+            for( std::size_t i = 1; i < values.size(); ++i )
+            {
+                total += (values[i - 1] == values[i]);
+            }
+            sink = sink + total;
+        });
+
+        measure("same type a < b", 10000, count, [&values]()
+        {
+            long total = 0;
+            for( std::size_t i = 1; i < values.size(); ++i )
+            {
+                total += (values[i - 1] < values[i]);
+            }
+            sink = sink + total;
+        });
+
+        std::vector<Any> mixed;
+        for( std::size_t i = 0; i < count; ++i )
+        {
+            if( i % 2 ) mixed.push_back(Any(static_cast<int>(i)));
+            else        mixed.push_back(Any(static_cast<long>(i)));
+        }
+        measure("mixed types a < b", 10000, count, [&mixed]()
+        {
+            long total = 0;
+            for( std::size_t i = 1; i < mixed.size(); ++i )
+            {
+                total += (mixed[i - 1] < mixed[i]);
+            }
+            sink = sink + total;
+        });
+
+        measure("std::sort mixed types", 100, count, [&mixed]()
+        {
+            std::vector<Any> sorted(mixed);
+            std::sort(sorted.begin(), sorted.end());
+            sink = sink + sorted.front().key();
+        });
+
+        measure("sort_anys mixed types", 100, count, [&mixed]()
+        {
+            std::vector<Any> sorted(mixed);
+            af::sort_anys(sorted.begin(), sorted.end());
+            sink = sink + sorted.front().key();
+        });
+    }
+}
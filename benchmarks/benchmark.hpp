@@ -0,0 +1,37 @@
+// Minimal timing support for the benchmarks; build with optimisation on.
+
+#ifndef ANY_FACADE_BENCHMARK_HPP_INCLUDED
+#define ANY_FACADE_BENCHMARK_HPP_INCLUDED
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+
+namespace benchmarks
+{
+    // results are added here so the measured work can't be optimised away
+    extern volatile long sink;
+
+    // run 'fn' (which does 'operations' operations) 'repeats' times and print
+    // the average time per operation
+    template <typename Function>
+    void measure(const char* name, std::size_t repeats, std::size_t operations, Function fn)
+    {
+        fn(); // warm up
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( std::size_t i = 0; i < repeats; ++i )
+        {
+            fn();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << std::left << std::setw(48) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(2)
+                  << elapsed.count() / (repeats * operations) << " ns/op" << std::endl;
+    }
+
+    void call_benchmarks();
+    void compare_benchmarks();
+}
+
+#endif // ANY_FACADE_BENCHMARK_HPP_INCLUDED
@@ -0,0 +1,13 @@
+#include "benchmark.hpp"
+
+namespace benchmarks
+{
+    volatile long sink = 0;
+}
+
+int main()
+{
+    benchmarks::call_benchmarks();
+    benchmarks::compare_benchmarks();
+    return 0;
+}
@@ -7,129 +7,370 @@
 #define ANY_FACADE_HPP_INCLUDED
 
 #include <member_function_traits.hpp>
+#include <cstddef>
+#include <new>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <memory>
 #ifdef ANY_FACADE_USE_RTTI
 #include <typeinfo>
+#include <map>
+#if __cplusplus > 199711L
+#include <mutex>
+#endif
 #endif
 #if __cplusplus > 199711L
 #include <type_traits>
+#include <atomic>
+#include <iterator>
+#include <vector>
+// holders are always the most derived class
+#define ANY_FACADE_FINAL final
+#else
+#define ANY_FACADE_FINAL
+#endif
+#if defined(__cpp_impl_three_way_comparison) && __cpp_impl_three_way_comparison >= 201907L
+#include <compare>
+#define ANY_FACADE_HAS_THREE_WAY_COMPARISON
+#endif
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define ANY_FACADE_HAS_MEMORY_RESOURCE
+#endif
 #endif
 
 namespace any_facade
 {
-#if __cplusplus > 199711L
-    typedef std::remove_reference remove_reference;
-    typedef std::remove_const remove_const;
-#else
+    // not std::remove_const; type ids treat 'const T*' the same as 'T*'
     template< class T > struct remove_reference      {typedef T type;};
     template< class T > struct remove_reference<T&>  {typedef T type;};
-#ifdef _MSC_VER
+#if __cplusplus > 199711L || defined(_MSC_VER)
     template< class T > struct remove_reference<T&&> {typedef T type;}; 
 #endif
     template< class T > struct remove_const          {typedef T type;};
     template< class T > struct remove_const<const T>  {typedef T type;};
     template< class T > struct remove_const<const T*>  {typedef T* type;};
+
+#if __cplusplus > 199711L
+    template< class F > struct is_const_member_function : std::false_type {};
+    template< class R, class C, class... Args >
+    struct is_const_member_function<R (C::*)(Args...) const> : std::true_type {};
+
+    //
+    // Forwarders should use plain, non-virtual functions; deriving a forwarder
+    // from the interface makes every any polymorphic and each call dispatch
+    // twice. Check each forwarding function against the interface instead:
+    //
+    //   static_assert(same_signature<decltype(&forwarder::f), decltype(&Interface::f)>::value, "");
+    //
+    template< class F1, class F2 > struct same_signature : std::false_type {};
+    template< class R, class C1, class C2, class... Args >
+    struct same_signature<R (C1::*)(Args...), R (C2::*)(Args...)> : std::true_type {};
+    template< class R, class C1, class C2, class... Args >
+    struct same_signature<R (C1::*)(Args...) const, R (C2::*)(Args...) const> : std::true_type {};
+
+    //
+    // same_signature only checks the functions a forwarder has. To have the
+    // compiler check that it has all of the interface's functions, write them
+    // in a class template on their base, calling through content():
+    //
+    //   template <typename Base>
+    //   struct shape_functions : public Base
+    //   {
+    //       double area() const { return this->content()->area(); }
+    //   };
+    //   template <>
+    //   class forwarder<Any> : public shape_functions<forwarding<Any> > {};
+    //   static_assert(forwards_all<shape_functions, Shape>::value, "shape_functions doesn't forward all of Shape");
+    //
+    // forwarding<Any> keeps the functions non-virtual; forwards_all derives
+    // them from the interface instead, where they override its functions, so
+    // that's abstract if one is missing or doesn't match.
+    //
+    template <typename Derived>
+    class forwarding
+    {
+    protected:
+        template <typename D = Derived>
+        typename D::InterfaceType* content()
+        {
+            return static_cast<D*>(this)->content;
+        }
+        template <typename D = Derived>
+        const typename D::InterfaceType* content() const
+        {
+            return static_cast<const D*>(this)->content;
+        }
+    };
+
+    template <typename Interface>
+    class forwarding_check : public Interface
+    {
+    protected:
+        // never called
+        Interface* content() { return 0; }
+        const Interface* content() const { return 0; }
+    };
+
+    template <template <typename> class Functions, typename Interface>
+    struct forwards_all
+    {
+        static const bool value = !std::is_abstract<Functions<forwarding_check<Interface> > >::value;
+    };
+
+    // anys, references to them and their holders all have an AnyType
+    template< class T, class Enable = void > struct is_any : std::false_type {};
+    template< class T >
+    struct is_any<T, typename std::conditional<true, void, typename T::AnyType>::type> : std::true_type {};
 #endif
 
 #ifdef ANY_FACADE_USE_RTTI
+    //
+    // Gives each std::type_info a small ordinal the first time it's seen, so
+    // type ids compare as integers; unlike hash_code() it doesn't hash the
+    // name on every call, and different types never collide
+    //
+    class rtti_ordinals
+    {
+    public:
+        static std::size_t of(const std::type_info& type)
+        {
+            registry& r = instance();
+#if __cplusplus > 199711L
+            std::lock_guard<std::mutex> lock(r.mutex);
+#endif
+            typename_map::iterator found = r.ordinals.find(&type);
+            if( found == r.ordinals.end() )
+            {
+                found = r.ordinals.insert(std::make_pair(&type, r.ordinals.size())).first;
+            }
+            return found->second;
+        }
+    private:
+        struct before
+        {
+            bool operator()(const std::type_info* lhs, const std::type_info* rhs) const
+            {
+                return lhs->before(*rhs) != 0;
+            }
+        };
+        typedef std::map<const std::type_info*, std::size_t, before> typename_map;
+        struct registry
+        {
+            typename_map ordinals;
+#if __cplusplus > 199711L
+            std::mutex mutex;
+#endif
+        };
+        static registry& instance()
+        {
+            static registry r;
+            return r;
+        }
+    };
+
     template <typename InterfaceClass>
     class type_info
     {
     private:
-        explicit type_info(const std::type_info& v)
+        explicit type_info(std::size_t v)
             : m_value(v)
         {}
-        type_info& operator=(const type_info&);
-        type_info();
 
-        const std::type_info& m_value;
+        std::size_t m_value;
 
     public:
-        type_info(const type_info&)
-            : m_value(rhs.m_value)
+        // no type yet
+        type_info()
+            : m_value(type_id<void>().m_value)
         {}
 
         template <typename T>
         static type_info type_id()
         {
-            return type_info(typeid(typename remove_const<typename remove_reference<T>::type>::type));
+            typedef typename remove_const<typename remove_reference<T>::type>::type Type;
+            // only looked up the first time
+            static const std::size_t ordinal = rtti_ordinals::of(typeid(Type));
+            return type_info(ordinal);
         }
-        bool operator == (const type_info& rhs)
+        bool operator == (const type_info& rhs) const
         {
-            return m_value.operator==(rhs.m_value);
+            return (m_value == rhs.m_value);
         }
-        bool operator != (const type_info& rhs)
+        bool operator != (const type_info& rhs) const
         {
             return !operator==(rhs);
         }
-        bool operator < (const type_info& rhs)
+        bool operator < (const type_info& rhs) const
         {
-            return (m_value.hash_code() < rhs.hash_code());
+            return (m_value < rhs.m_value);
         }
-        size_t hash_code() const {return m_value.hash_code();}
+        size_t hash_code() const {return m_value;}
     };
 
 #else // ANY_FACADE_USE_RTTI
 
+#if __cplusplus >= 201402L
+#if defined(_MSC_VER)
+#define ANY_FACADE_SIGNATURE __FUNCSIG__
+#else
+#define ANY_FACADE_SIGNATURE __PRETTY_FUNCTION__
+#endif
+#define ANY_FACADE_TYPE_ID_CONSTEXPR constexpr
+
+    // 64 bit FNV-1a
+    constexpr unsigned long long fnv1a_hash(const char* s)
+    {
+        unsigned long long hash = 14695981039346656037ull;
+        while( *s )
+        {
+            hash = (hash ^ static_cast<unsigned char>(*s++)) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // the signature names T, so its hash orders T the same way on every run;
+    // computed by the compiler. It isn't T's identity: types that print the
+    // same (local classes of one function, lambdas, types in anonymous
+    // namespaces in different translation units...) get the same hash
+    template <typename T>
+    constexpr size_t type_hash()
+    {
+        return static_cast<size_t>(fnv1a_hash(ANY_FACADE_SIGNATURE));
+    }
+
+    // what a type id points to, so it's a single word in each holder
+    struct type_descriptor
+    {
+        // the type's identity
+        const char* tag;
+        // orders types, ties (different types with the same hash) are
+        // broken by their descriptors' addresses
+        size_t order;
+    };
+#else
+#define ANY_FACADE_TYPE_ID_CONSTEXPR
+#endif
+
+    // one per type; the address of 'id' is the type's identity, which the
+    // linker assigns, so there's nothing to initialize (or race on) at run
+    // time. Not const, so identical constant folding can't merge the tags;
+    // and as descriptors hold their tag's address, they can't be merged either.
+    template <typename T>
+    struct type_tag
+    {
+        static char id;
+#if __cplusplus >= 201402L
+        static constexpr type_descriptor descriptor = { &id, std::integral_constant<size_t, type_hash<T>()>::value };
+#endif
+    };
+
+    template <typename T>
+    //static
+    char type_tag<T>::id = 0;
+
+#if __cplusplus >= 201402L && __cplusplus < 201703L
+    template <typename T>
+    //static
+    constexpr type_descriptor type_tag<T>::descriptor;
+#endif
+
     template <typename InterfaceClass>
     class type_info
     {
     private:
-        explicit type_info(size_t v)
-            : m_value(v)
+#if __cplusplus >= 201402L
+        explicit constexpr type_info(const type_descriptor* type)
+            : m_type(type)
         {}
 
-        size_t m_value;
+        const type_descriptor* m_type;
+
+        template <typename T>
+        static constexpr type_info base_type_id()
+        {
+            return type_info(&type_tag<T>::descriptor);
+        }
+#else
+        explicit type_info(const char* tag)
+            : m_tag(tag)
+        {}
 
-        static size_t s_type;
+        // the type's identity, and its order
+        const char* m_tag;
 
         template <typename T>
         static type_info base_type_id()
         {
-            static bool init(false);
-            static size_t result;
-            if( !init )
-            {
-                result = ++s_type;
-                init = true;
-            }
-            return type_info(result);
+            return type_info(&type_tag<T>::id);
         }
+#endif
     public:
+        // no type yet
+#if __cplusplus >= 201402L
+        constexpr type_info()
+            : m_type(&type_tag<void>::descriptor)
+        {}
+#else
+        type_info()
+            : m_tag(0)
+        {}
+#endif
+
         template <typename T>
-        static type_info type_id()
+        static ANY_FACADE_TYPE_ID_CONSTEXPR type_info type_id()
         {
             return base_type_id<typename remove_const<typename remove_reference<T>::type>::type>();
         }
-        bool operator == (const type_info& rhs)
+#if __cplusplus >= 201402L
+        constexpr bool operator == (const type_info& rhs) const
         {
-            return (m_value == rhs.m_value);
+            return (m_type == rhs.m_type);
+        }
+#else
+        bool operator == (const type_info& rhs) const
+        {
+            return (m_tag == rhs.m_tag);
         }
-        bool operator != (const type_info& rhs)
+#endif
+        ANY_FACADE_TYPE_ID_CONSTEXPR bool operator != (const type_info& rhs) const
         {
             return !operator==(rhs);
         }
-        bool operator < (const type_info& rhs)
+#if __cplusplus >= 201402L
+        constexpr bool operator < (const type_info& rhs) const
         {
-            return (m_value < rhs.m_value);
+            return (m_type->order != rhs.m_type->order) ? (m_type->order < rhs.m_type->order)
+                                                         : std::less<const type_descriptor*>()(m_type, rhs.m_type);
         }
-        size_t hash_code() const {return m_value;}
+        // the same on every run, but not unique
+        constexpr size_t hash_code() const {return m_type->order;}
+#else
+        bool operator < (const type_info& rhs) const
+        {
+            return std::less<const char*>()(m_tag, rhs.m_tag);
+        }
+        size_t hash_code() const {return reinterpret_cast<size_t>(m_tag);}
+#endif
     };
 
-    template <typename InterfaceClass>
-    //static
-    size_t type_info<InterfaceClass>::s_type = 0;
-
 #endif // ANY_FACADE_USE_RTTI
 
     //
     // Comparability classes...specialize for specific types as required
     //
+    // compare<Base,T> adds the virtual comparisons of a placeholder T on top of
+    // its interface Base, so they share Base's vptr rather than adding another.
+    // compare2<Derived,T> implements them for the holder Derived, which is
+    // final, so calls through Derived (e.g. its own type()) are direct
+    //
     struct not_comparable
     {
-        template <typename T>
-        struct compare
+        template <typename Base, typename T>
+        struct compare : public Base
         {
-            virtual ~compare() {}
         };
         template <typename Derived, typename T>
         struct compare2 : public T
@@ -142,10 +383,9 @@ namespace any_facade
     //
     struct equality_comparable
     {
-        template <typename T>
-        struct compare
+        template <typename Base, typename T>
+        struct compare : public Base
         {
-            virtual ~compare() {}
             virtual bool equals(const T& other) const = 0;
         };
         template <typename Derived, typename T>
@@ -154,7 +394,7 @@ namespace any_facade
             typedef T PlaceholderType;
             virtual bool equals(const T& other) const
             {
-                if( this->type() == other.type() )
+                if( static_cast<const Derived*>(this)->type() == other.type() )
                 {
                     // objects of the same type...value type comparison
                     const Derived* otherType = static_cast<const Derived*>(&other);
@@ -174,10 +414,9 @@ namespace any_facade
     //
     struct less_than_comparable
     {
-        template <typename T>
-        struct compare
+        template <typename Base, typename T>
+        struct compare : public Base
         {
-            virtual ~compare() {}
             virtual bool less(const T& other) const = 0;
         };
         template <typename Derived, typename T>
@@ -186,13 +425,13 @@ namespace any_facade
             typedef T PlaceholderType;
             virtual bool less(const T& other) const
             {
-                if( this->type() == other.type() )
+                if( static_cast<const Derived*>(this)->type() == other.type() )
                 {
                     // objects of the same type...value type comparison
                     const Derived* otherType = static_cast<const Derived*>(&other);
                     return less_than_comparable::less(static_cast<const Derived*>(this)->value(), otherType->value());
                 }
-                if( this->type() < other.type() ) return true;
+                if( static_cast<const Derived*>(this)->type() < other.type() ) return true;
                 
                 return false;
             }
@@ -208,8 +447,8 @@ namespace any_facade
     //
     struct less_than_equals_comparable : public equality_comparable, public less_than_comparable
     {
-        template <typename T>
-        struct compare : public equality_comparable::compare<T>, public less_than_comparable::compare<T>
+        template <typename Base, typename T>
+        struct compare : public equality_comparable::compare<less_than_comparable::compare<Base, T>, T>
         {
         };
         template <typename Derived, typename T>
@@ -218,7 +457,7 @@ namespace any_facade
             typedef T PlaceholderType;
             virtual bool equals(const T& other) const
             {
-                if( this->type() == other.type() )
+                if( static_cast<const Derived*>(this)->type() == other.type() )
                 {
                     // objects of the same type...value type comparison
                     const Derived* otherType = static_cast<const Derived*>(&other);
@@ -228,295 +467,2672 @@ namespace any_facade
             }
             virtual bool less(const T& other) const
             {
-                if( this->type() == other.type() )
+                if( static_cast<const Derived*>(this)->type() == other.type() )
                 {
                     // objects of the same type...value type comparison
                     const Derived* otherType = static_cast<const Derived*>(&other);
                     return less_than_comparable::less(static_cast<const Derived*>(this)->value(), otherType->value());
                 }
-                if( this->type() < other.type() ) return true;
+                if( static_cast<const Derived*>(this)->type() < other.type() ) return true;
                 
                 return false;
             }
         };
     };
 
-    template <typename Derived, typename Base, typename ValueType>
-    class value_type_operations;
-
-    template <typename Derived>
-    class forwarder;
-
-    template <int N>
-    struct null_base { virtual ~null_base() {} };
-
-    template <typename I0 = null_base<0>,
-                typename I1 = null_base<1>,
-                typename I2 = null_base<2>,
-                typename I3 = null_base<3>,
-                typename I4 = null_base<4>,
-                typename I5 = null_base<5>,
-                typename I6 = null_base<6> >
-    struct interfaces : public I0, public I1, public I2, public I3, public I4, public I5, public I6
-    {};
-
-    template <typename Interface, typename Comparable>
-    class any;
-
-    template <typename Interface = interfaces<>, typename Comparable = less_than_equals_comparable>
-    class any : public forwarder<any<Interface,Comparable> >
+    //
+    // comparability from a single three way comparison, so each ==, < or <=>
+    // is one virtual call. If your class doesn't support operator<(), specialize
+    // three_way() (negative, zero or positive, like strcmp)...
+    //
+    struct three_way_comparable
     {
-        // CRTP base class has access to 'content'
-        friend class forwarder<any>;
-    public:
-        typedef any AnyType;
-    private:
-        class placeholder : public Interface, public Comparable::template compare<placeholder>
+        template <typename Base, typename T>
+        struct compare : public Base
         {
-        public: // queries
-            virtual type_info<any> type() const  = 0;
-            virtual placeholder* clone() const = 0;
+            virtual int compare_to(const T& other) const = 0;
+            bool equals(const T& other) const { return compare_to(other) == 0; }
+            bool less(const T& other) const { return compare_to(other) < 0; }
         };
-    public:
-        //
-        // This has to be the most derived class so that 'clone' doesn't slice,
-        // so we use CRTP to enforce this condition
-        //
-        template<typename T>
-        class holder : public value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T>
+        template <typename Derived, typename T>
+        struct compare2 : public T
         {
-            // CRTP base class has access to 'held'
-            friend class value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T>;
-        public: // structors
-            typedef any AnyType;
-            typedef T ValueType;
-
-            explicit holder(const ValueType & v)
-                : held(v)
-            {
-            }
-
-        public: // queries
-
-            ValueType value() const { return held; }
-
-            virtual type_info<any> type() const
-            {
-                return type_info<any>::template type_id<ValueType>();
-            }
-            virtual placeholder* clone() const
+            typedef T PlaceholderType;
+            virtual int compare_to(const T& other) const
             {
-                return new holder(*this);
+                const Derived* self = static_cast<const Derived*>(this);
+                if( self->type() == other.type() )
+                {
+                    // objects of the same type...value type comparison
+                    const Derived* otherType = static_cast<const Derived*>(&other);
+                    return three_way_comparable::three_way(self->value(), otherType->value());
+                }
+                return (self->type() < other.type()) ? -1 : 1;
             }
-
-        private: // intentionally left unimplemented
-            holder & operator=(const holder &);
-
-        private: // representation
-
-            ValueType held;
         };
-
-    public: // structors
-
-        any()
-            : content(0)
+        template <typename T>
+        static int three_way(const T& lhs, const T& rhs)
         {
+            return (lhs < rhs) ? -1 : ((rhs < lhs) ? 1 : 0);
         }
-
-        template<typename ValueType>
-        any(const ValueType & value)
-            : content(new holder<ValueType>(value))
+        template <typename T>
+        static bool equals(const T& lhs, const T& rhs)
         {
+            return three_way_comparable::three_way(lhs, rhs) == 0;
         }
-
-        any(const any & other)
-            : content(other.content ? other.content->clone() : 0)
+        template <typename T>
+        static bool less(const T& lhs, const T& rhs)
         {
+            return three_way_comparable::three_way(lhs, rhs) < 0;
         }
+    };
 
-        ~any()
+    //
+    // Orders by a key projected from each value (an integer, string_view,
+    // tuple...) which the holder calculates when it's made and keeps, so
+    // ==, != and < only make a virtual call when the keys are equal. Keys must
+    // order values the same way their own < does; specialize key() to project
+    // a value and equals_tied()/less_tied() in value_type_operations to break
+    // ties between types differently...
+    //
+    template <typename Key>
+    struct projected_key
+    {
+        template <typename Base, typename T>
+        struct compare : public Base
         {
-            delete content;
-        }
-
-    public: // modifiers
-
-        any & swap(any & rhs)
+            virtual bool equals_tied(const T& other) const = 0;
+            virtual bool less_tied(const T& other) const = 0;
+            bool equals(const T& other) const
+            {
+                return (m_key == other.key()) && equals_tied(other);
+            }
+            bool less(const T& other) const
+            {
+                if( m_key < other.key() ) return true;
+                if( other.key() < m_key ) return false;
+                return less_tied(other);
+            }
+            const Key& key() const { return m_key; }
+        protected:
+            Key m_key;
+        };
+        template <typename Derived, typename T>
+        struct compare2 : public T
         {
-            std::swap(content, rhs.content);
-            return *this;
-        }
-
-        any & operator=(any rhs)
+            typedef T PlaceholderType;
+            // called by the holder once its value is in place
+            void constructed()
+            {
+                this->m_key = projected_key::key(static_cast<const Derived*>(this)->value());
+            }
+            virtual bool equals_tied(const T& other) const
+            {
+                if( static_cast<const Derived*>(this)->type() == other.type() )
+                {
+                    // objects of the same type...value type comparison
+                    const Derived* otherType = static_cast<const Derived*>(&other);
+                    return equality_comparable::equals(static_cast<const Derived*>(this)->value(), otherType->value());
+                }
+                return false;
+            }
+            virtual bool less_tied(const T& other) const
+            {
+                if( static_cast<const Derived*>(this)->type() == other.type() )
+                {
+                    // objects of the same type...value type comparison
+                    const Derived* otherType = static_cast<const Derived*>(&other);
+                    return less_than_comparable::less(static_cast<const Derived*>(this)->value(), otherType->value());
+                }
+                return static_cast<const Derived*>(this)->type() < other.type();
+            }
+        };
+        template <typename T>
+        static Key key(const T& value)
         {
-            any(rhs).swap(*this);
-            return *this;
+            return Key(value);
         }
-
-        // interface forwarding, allow up to 10 params
-        template <typename Function>
-        typename member_function_traits<Function>::result_type call(Function fn)
+        template <typename T>
+        static bool equals(const T& lhs, const T& rhs)
         {
-            return (content->*fn)();
+            return equality_comparable::equals(lhs, rhs);
         }
-
-        template <typename Function>
-        typename member_function_traits<Function>::result_type call(
-            Function fn,
-            typename member_function_traits<Function>::arg1_type t1)
+        template <typename T>
+        static bool less(const T& lhs, const T& rhs)
         {
-            return (content->*fn)(t1);
+            return less_than_comparable::less(lhs, rhs);
         }
+    };
 
-        template <typename Function>
+#if __cplusplus > 199711L
+    //
+    // If your class can be hashed, but doesn't specialize std::hash, specialize this class...
+    //
+    struct hashable
+    {
+        template <typename Base, typename T>
+        struct compare : public Base
+        {
+            std::size_t hash() const { return compute_hash(); }
+            virtual std::size_t compute_hash() const = 0;
+        };
+        template <typename Derived, typename T>
+        struct compare2 : public T
+        {
+            typedef T PlaceholderType;
+            virtual std::size_t compute_hash() const
+            {
+                return hashable::hash(static_cast<const Derived*>(this)->value());
+            }
+        };
+        template <typename T>
+        static std::size_t hash(const T& value)
+        {
+            return std::hash<T>()(value);
+        }
+    };
+    //
+    // comparability for hashed containers, e.g. keys of std::unordered_map...
+    //
+    struct hashable_equality_comparable : public equality_comparable, public hashable
+    {
+        template <typename Base, typename T>
+        struct compare : public equality_comparable::compare<hashable::compare<Base, T>, T>
+        {
+        };
+        template <typename Derived, typename T>
+        struct compare2 : public equality_comparable::compare2<Derived, T>
+        {
+            virtual std::size_t compute_hash() const
+            {
+                return hashable::hash(static_cast<const Derived*>(this)->value());
+            }
+        };
+    };
+    //
+    // Keeps the hash in the placeholder once it's been calculated, e.g.
+    // cached_hash<hashable_equality_comparable>, so only the first hash is a
+    // virtual call; only for values that don't change once they've been hashed
+    //
+    template <typename Hashable>
+    struct cached_hash : public Hashable
+    {
+        template <typename Base, typename T>
+        struct compare : public Hashable::template compare<Base, T>
+        {
+            compare()
+                : m_hash(0)
+            {
+            }
+            compare(const compare& other)
+                : Hashable::template compare<Base, T>(other), m_hash(other.m_hash.load(std::memory_order_relaxed))
+            {
+            }
+            std::size_t hash() const
+            {
+                // 0 means not calculated yet (or a hash of 0, which is just recalculated)
+                std::size_t result = m_hash.load(std::memory_order_relaxed);
+                if( !result )
+                {
+                    result = this->compute_hash();
+                    m_hash.store(result, std::memory_order_relaxed);
+                }
+                return result;
+            }
+        private:
+            mutable std::atomic<std::size_t> m_hash;
+        };
+    };
+
+    //
+    // Small indices for the value types of AnyType, given out on first use,
+    // so per type tables can be dense arrays
+    //
+    template <typename AnyType>
+    class type_ordinals
+    {
+    public:
+        template <typename T>
+        static std::size_t of()
+        {
+            static const std::size_t result = next().fetch_add(1);
+            return result;
+        }
+    private:
+        static std::atomic<std::size_t>& next()
+        {
+            static std::atomic<std::size_t> ordinal(0);
+            return ordinal;
+        }
+    };
+
+    //
+    // Functions on pairs of value types held by AnyType, e.g. comparisons
+    // between different types, in a matrix indexed by type ordinal; finding one
+    // is a single lookup however many are registered. Operation keeps tables
+    // apart; an equality_comparable function is also registered for the
+    // swapped pair, so == stays symmetric. Register the functions before the
+    // anys are used on several threads.
+    //
+    template <typename AnyType, typename Operation, typename Result = bool>
+    class binary_dispatch
+    {
+    public:
+        // called with the two anys' placeholders, or with a raw value in
+        // place of one of them (e.g. when an any is compared with a value)
+        typedef Result (*function_type)(const void* lhs, const void* rhs);
+        enum operands { both_held, lhs_held, rhs_held };
+
+        template <typename A, typename B, Result (*Fn)(const A&, const B&)>
+        static void add()
+        {
+            cell functions;
+            functions.invokers[both_held] = &invoke<A, B, Fn, true, true>;
+            functions.invokers[lhs_held] = &invoke<A, B, Fn, true, false>;
+            functions.invokers[rhs_held] = &invoke<A, B, Fn, false, true>;
+            set(type_ordinals<AnyType>::template of<A>(), type_ordinals<AnyType>::template of<B>(), functions);
+            if( std::is_same<Operation, equality_comparable>::value && !std::is_same<A, B>::value )
+            {
+                cell swapped;
+                swapped.invokers[both_held] = &invoke_swapped<A, B, Fn, true, true>;
+                swapped.invokers[lhs_held] = &invoke_swapped<A, B, Fn, true, false>;
+                swapped.invokers[rhs_held] = &invoke_swapped<A, B, Fn, false, true>;
+                set(type_ordinals<AnyType>::template of<B>(), type_ordinals<AnyType>::template of<A>(), swapped);
+            }
+        }
+
+        // the function for the types with ordinals 'lhs' and 'rhs', or 0 if there isn't one
+        static function_type find(std::size_t lhs, std::size_t rhs, operands held = both_held)
+        {
+            const matrix& m = functions();
+            return (lhs < m.size && rhs < m.size) ? m.cells[lhs * m.size + rhs].invokers[held] : 0;
+        }
+
+    private:
+        template <typename V, bool Held>
+        static const V& operand(const void* p)
+        {
+            typedef typename AnyType::template holder<V> Holder;
+            typedef typename Holder::PlaceholderType PlaceholderType;
+            return Held ? static_cast<const Holder*>(static_cast<const PlaceholderType*>(p))->value()
+                        : *static_cast<const V*>(p);
+        }
+
+        template <typename A, typename B, Result (*Fn)(const A&, const B&), bool LhsHeld, bool RhsHeld>
+        static Result invoke(const void* lhs, const void* rhs)
+        {
+            return Fn(operand<A, LhsHeld>(lhs), operand<B, RhsHeld>(rhs));
+        }
+        // 'lhs' is the B, 'rhs' the A
+        template <typename A, typename B, Result (*Fn)(const A&, const B&), bool LhsHeld, bool RhsHeld>
+        static Result invoke_swapped(const void* lhs, const void* rhs)
+        {
+            return Fn(operand<A, RhsHeld>(rhs), operand<B, LhsHeld>(lhs));
+        }
+
+        struct cell
+        {
+            cell() { invokers[both_held] = invokers[lhs_held] = invokers[rhs_held] = 0; }
+            function_type invokers[3];
+        };
+
+        struct matrix
+        {
+            matrix() : size(0) {}
+            std::size_t size;
+            std::vector<cell> cells;
+        };
+
+        static matrix& functions()
+        {
+            static matrix m;
+            return m;
+        }
+
+        static void set(std::size_t lhs, std::size_t rhs, const cell& fn)
+        {
+            matrix& m = functions();
+            const std::size_t size = std::max(m.size, std::max(lhs, rhs) + 1);
+            if( size != m.size )
+            {
+                std::vector<cell> cells(size * size);
+                for( std::size_t i = 0; i < m.size; ++i )
+                {
+                    std::copy(m.cells.begin() + i * m.size, m.cells.begin() + (i + 1) * m.size, cells.begin() + i * size);
+                }
+                m.cells.swap(cells);
+                m.size = size;
+            }
+            m.cells[lhs * m.size + rhs] = fn;
+        }
+    };
+
+    //
+    // Comparable, plus == and < between different value types registered in
+    // binary_dispatch<AnyType, equality_comparable> and
+    // binary_dispatch<AnyType, less_than_comparable>, e.g.
+    //
+    //   binary_dispatch<Any, equality_comparable>::add<Meters, Feet, &equals>();
+    //
+    // Pairs that aren't registered compare as they do with Comparable
+    //
+    template <typename Comparable>
+    struct cross_type_comparable;
+
+    // the placeholder keeps its value type's ordinal, so finding a function
+    // doesn't need a virtual call per any
+    template <typename Base>
+    struct cross_type_placeholder : public Base
+    {
+        std::size_t ordinal() const { return m_ordinal; }
+    protected:
+        std::size_t m_ordinal;
+    };
+
+    template <typename Derived, typename T, typename Base>
+    struct cross_type_ordinal : public Base
+    {
+        // called by the holder once its value is in place
+        void constructed()
+        {
+            this->m_ordinal = type_ordinals<typename Derived::AnyType>::template of<typename Derived::ValueType>();
+            Base::constructed();
+        }
+    };
+
+    template <typename Derived, typename T, typename Base>
+    struct cross_type_equals : public Base
+    {
+        virtual bool equals(const T& other) const
+        {
+            const Derived* self = static_cast<const Derived*>(this);
+            if( self->type() != other.type() )
+            {
+                typedef binary_dispatch<typename Derived::AnyType, equality_comparable> table;
+                typename table::function_type fn = table::find(self->ordinal(), other.ordinal());
+                if( fn ) return fn(static_cast<const T*>(this), &other);
+            }
+            return Base::equals(other);
+        }
+    };
+
+    template <typename Derived, typename T, typename Base>
+    struct cross_type_less : public Base
+    {
+        virtual bool less(const T& other) const
+        {
+            const Derived* self = static_cast<const Derived*>(this);
+            if( self->type() != other.type() )
+            {
+                typedef binary_dispatch<typename Derived::AnyType, less_than_comparable> table;
+                typename table::function_type fn = table::find(self->ordinal(), other.ordinal());
+                if( fn ) return fn(static_cast<const T*>(this), &other);
+            }
+            return Base::less(other);
+        }
+    };
+
+    template <>
+    struct cross_type_comparable<equality_comparable> : public equality_comparable
+    {
+        template <typename Base, typename T>
+        struct compare : public equality_comparable::compare<cross_type_placeholder<Base>, T>
+        {
+        };
+        template <typename Derived, typename T>
+        struct compare2 : public cross_type_equals<Derived, T, cross_type_ordinal<Derived, T, equality_comparable::compare2<Derived, T> > >
+        {
+        };
+    };
+
+    template <>
+    struct cross_type_comparable<less_than_comparable> : public less_than_comparable
+    {
+        template <typename Base, typename T>
+        struct compare : public less_than_comparable::compare<cross_type_placeholder<Base>, T>
+        {
+        };
+        template <typename Derived, typename T>
+        struct compare2 : public cross_type_less<Derived, T, cross_type_ordinal<Derived, T, less_than_comparable::compare2<Derived, T> > >
+        {
+        };
+    };
+
+    template <>
+    struct cross_type_comparable<less_than_equals_comparable> : public less_than_equals_comparable
+    {
+        template <typename Base, typename T>
+        struct compare : public less_than_equals_comparable::compare<cross_type_placeholder<Base>, T>
+        {
+        };
+        template <typename Derived, typename T>
+        struct compare2 : public cross_type_less<Derived, T, cross_type_equals<Derived, T,
+                                 cross_type_ordinal<Derived, T, less_than_equals_comparable::compare2<Derived, T> > > >
+        {
+        };
+    };
+
+    // orders the indices of holders of one value type by their values
+    template <typename Derived, typename T, typename Comparable>
+    struct same_type_less
+    {
+        explicit same_type_less(const T* const* holders) : holders(holders) {}
+        bool operator()(std::size_t lhs, std::size_t rhs) const
+        {
+            return Comparable::less(static_cast<const Derived*>(holders[lhs])->value(),
+                                    static_cast<const Derived*>(holders[rhs])->value());
+        }
+        const T* const* holders;
+    };
+
+    template <typename Comparable>
+    struct orders_by_type;
+
+    //
+    // Comparable, declaring that values of different types are ordered by
+    // their type ids alone (or by the functions registered in binary_dispatch,
+    // with cross_type_comparable), so sort_anys can sort each type on its own,
+    // e.g. type_ordered<less_than_comparable>. Don't use it if
+    // value_type_operations overrides equals or less
+    //
+    template <typename Comparable>
+    struct type_ordered : public Comparable
+    {
+        template <typename Base, typename T>
+        struct compare : public Comparable::template compare<Base, T>
+        {
+            // used by sort_anys; 'holders' indexed by [first, last) are all of this type
+            virtual void sort_same_type(const T* const* holders, std::size_t* first, std::size_t* last) const = 0;
+        };
+        template <typename Derived, typename T>
+        struct compare2 : public Comparable::template compare2<Derived, T>
+        {
+            virtual void sort_same_type(const T* const* holders, std::size_t* first, std::size_t* last) const
+            {
+                std::sort(first, last, same_type_less<Derived, T, Comparable>(holders));
+            }
+        };
+
+        static_assert(orders_by_type<type_ordered>::value, "Comparable doesn't order different types by type id");
+    };
+#endif
+
+    //
+    // Storage classes...decide where the holder for a value type lives
+    //
+    template <typename T>
+    struct alignment_of
+    {
+        struct padded { char c; T t; };
+        static const std::size_t value = sizeof(padded) - sizeof(T);
+    };
+
+    template <bool Condition>
+    struct static_check;
+    template <>
+    struct static_check<true> {};
+
+    //
+    // Allocate a holder on the free store, keeping any extended alignment of
+    // its value type
+    //
+    template <typename Holder>
+    void* allocate_holder()
+    {
+#ifdef __cpp_aligned_new
+        if( alignment_of<Holder>::value > __STDCPP_DEFAULT_NEW_ALIGNMENT__ )
+        {
+            return ::operator new(sizeof(Holder), std::align_val_t(alignment_of<Holder>::value));
+        }
+#elif __cplusplus > 199711L
+        static_assert(alignof(Holder) <= alignof(std::max_align_t), "over-aligned value types need aligned new (C++17)");
+#endif
+        return ::operator new(sizeof(Holder));
+    }
+    template <typename Holder>
+    void deallocate_holder(void* p)
+    {
+#ifdef __cpp_aligned_new
+        if( alignment_of<Holder>::value > __STDCPP_DEFAULT_NEW_ALIGNMENT__ )
+        {
+            ::operator delete(p, std::align_val_t(alignment_of<Holder>::value));
+            return;
+        }
+#endif
+        ::operator delete(p);
+    }
+
+    //
+    // Every holder is allocated on the free store (the default)
+    //
+    struct heap_storage
+    {
+        static const bool has_buffer = false;
+        // can_adopt() is always true, so moving an any never allocates
+        static const bool always_adopts = true;
+
+        template <typename Holder>
+        struct stores_inline
+        {
+            static const bool value = false;
+        };
+        template <typename Holder>
+        void* allocate()
+        {
+            return allocate_holder<Holder>();
+        }
+        template <typename Holder>
+        void deallocate(void* p)
+        {
+            deallocate_holder<Holder>(p);
+        }
+        bool can_adopt(const heap_storage&) const
+        {
+            return true;
+        }
+    };
+    //
+    // Holders of up to 'Size' bytes (the value type plus the placeholder's
+    // vtable pointers) are constructed inside the any, larger ones on the heap
+    //
+    template <std::size_t Size = 4 * sizeof(void*)>
+    struct small_buffer
+    {
+    private:
+        union buffer_type
+        {
+            char data[Size];
+            long double ld;
+            long l;
+            void* p;
+            void (*fp)();
+        };
+        buffer_type m_buffer;
+    public:
+        static const bool has_buffer = true;
+        static const bool always_adopts = true;
+
+        small_buffer() {}
+        // the buffer belongs to the any, it's never copied
+        small_buffer(const small_buffer&) {}
+        small_buffer& operator=(const small_buffer&) { return *this; }
+
+        template <typename Holder>
+        struct stores_inline
+        {
+            static const bool value = (sizeof(Holder) <= Size) &&
+                            (alignment_of<buffer_type>::value % alignment_of<Holder>::value == 0)
+#if __cplusplus > 199711L
+                            // moving an any mustn't throw
+                            && std::is_nothrow_move_constructible<Holder>::value
+#endif
+                            ;
+        };
+        template <typename Holder>
+        void* allocate()
+        {
+            if( stores_inline<Holder>::value )
+            {
+                return &m_buffer;
+            }
+            return allocate_holder<Holder>();
+        }
+        template <typename Holder>
+        void deallocate(void* p)
+        {
+            if( !stores_inline<Holder>::value )
+            {
+                deallocate_holder<Holder>(p);
+            }
+        }
+        bool can_adopt(const small_buffer&) const
+        {
+            return true;
+        }
+    };
+    //
+    // As small_buffer, but a value type that doesn't fit won't compile;
+    // use this where any must never allocate
+    //
+    template <std::size_t Size = 4 * sizeof(void*)>
+    struct small_buffer_only : public small_buffer<Size>
+    {
+        template <typename Holder>
+        void* allocate()
+        {
+#if __cplusplus > 199711L
+            static_assert(small_buffer<Size>::template stores_inline<Holder>::value,
+                            "value type does not fit in small_buffer_only storage");
+#else
+            (void)sizeof(static_check<small_buffer<Size>::template stores_inline<Holder>::value>);
+#endif
+            return small_buffer<Size>::template allocate<Holder>();
+        }
+    };
+    //
+    // Holders are allocated with a (possibly stateful) allocator that is
+    // copied along with the any, e.g. to keep all the values in an arena
+    //
+    template <typename Allocator = std::allocator<char> >
+    struct allocator_storage
+    {
+    private:
+        Allocator m_allocator;
+#if __cplusplus > 199711L
+        template <typename Holder>
+        struct rebind
+        {
+            typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Holder> type;
+        };
+#else
+        template <typename Holder>
+        struct rebind
+        {
+            typedef typename Allocator::template rebind<Holder>::other type;
+        };
+#endif
+    public:
+        static const bool has_buffer = false;
+#if __cplusplus > 199711L
+        static const bool always_adopts = std::allocator_traits<Allocator>::is_always_equal::value;
+#else
+        static const bool always_adopts = false;
+#endif
+
+        allocator_storage()
+            : m_allocator()
+        {}
+        allocator_storage(const Allocator& allocator)
+            : m_allocator(allocator)
+        {}
+
+        template <typename Holder>
+        struct stores_inline
+        {
+            static const bool value = false;
+        };
+        template <typename Holder>
+        void* allocate()
+        {
+            typename rebind<Holder>::type allocator(m_allocator);
+            return allocator.allocate(1);
+        }
+        template <typename Holder>
+        void deallocate(void* p)
+        {
+            typename rebind<Holder>::type allocator(m_allocator);
+            allocator.deallocate(static_cast<Holder*>(p), 1);
+        }
+        bool can_adopt(const allocator_storage& other) const
+        {
+            return (m_allocator == other.m_allocator);
+        }
+    };
+
+#ifdef ANY_FACADE_HAS_MEMORY_RESOURCE
+    typedef allocator_storage<std::pmr::polymorphic_allocator<char> > pmr_storage;
+#endif
+
+#if __cplusplus > 199711L
+    //
+    // Thread local free lists of blocks, one list per size class, so that
+    // holders of similar sized value types reuse each other's memory without
+    // locking. Blocks freed on another thread join that thread's lists.
+    //
+    class free_list_pool
+    {
+    public:
+        static const std::size_t granularity = 16;
+        static const std::size_t size_classes = 16;  // pools holders up to 256 bytes
+        static const std::size_t max_cached = 256;   // per size class and thread
+
+        static void* allocate(std::size_t size)
+        {
+            const std::size_t index = size_class(size);
+            if( index < size_classes )
+            {
+                if( !destroyed() )
+                {
+                    lists& l = local();
+                    if( node* n = l.head[index] )
+                    {
+                        l.head[index] = n->next;
+                        --l.count[index];
+                        return n;
+                    }
+                }
+                // always the whole size class, as the block may be freed
+                // into another thread's list
+                return ::operator new((index + 1) * granularity);
+            }
+            return ::operator new(size);
+        }
+        static void deallocate(void* p, std::size_t size)
+        {
+            const std::size_t index = size_class(size);
+            if( index < size_classes && !destroyed() )
+            {
+                lists& l = local();
+                if( l.count[index] < max_cached )
+                {
+                    node* n = static_cast<node*>(p);
+                    n->next = l.head[index];
+                    l.head[index] = n;
+                    ++l.count[index];
+                    return;
+                }
+            }
+            ::operator delete(p);
+        }
+
+    private:
+        struct node
+        {
+            node* next;
+        };
+        struct lists
+        {
+            node* head[size_classes];
+            std::size_t count[size_classes];
+
+            lists()
+            {
+                for( std::size_t i = 0; i < size_classes; ++i )
+                {
+                    head[i] = 0;
+                    count[i] = 0;
+                }
+            }
+            ~lists()
+            {
+                for( std::size_t i = 0; i < size_classes; ++i )
+                {
+                    while( node* n = head[i] )
+                    {
+                        head[i] = n->next;
+                        ::operator delete(n);
+                    }
+                }
+                // anything released later in this thread's shutdown goes straight back
+                destroyed() = true;
+            }
+        };
+
+        static std::size_t size_class(std::size_t size)
+        {
+            return (size - 1) / granularity;
+        }
+        static lists& local()
+        {
+            static thread_local lists l;
+            return l;
+        }
+        static bool& destroyed()
+        {
+            static thread_local bool d = false;
+            return d;
+        }
+    };
+
+    //
+    // Holders are allocated from free_list_pool (opt in); for value types that
+    // are created and destroyed constantly
+    //
+    struct pooled_storage
+    {
+        static const bool has_buffer = false;
+        static const bool always_adopts = true;
+
+        template <typename Holder>
+        struct stores_inline
+        {
+            static const bool value = false;
+        };
+        // pooled blocks only have the default alignment, so over-aligned
+        // holders skip the pool
+        template <typename Holder>
+        void* allocate()
+        {
+            if( alignof(Holder) > alignof(std::max_align_t) )
+            {
+                return allocate_holder<Holder>();
+            }
+            return free_list_pool::allocate(sizeof(Holder));
+        }
+        template <typename Holder>
+        void deallocate(void* p)
+        {
+            if( alignof(Holder) > alignof(std::max_align_t) )
+            {
+                deallocate_holder<Holder>(p);
+                return;
+            }
+            free_list_pool::deallocate(p, sizeof(Holder));
+        }
+        bool can_adopt(const pooled_storage&) const
+        {
+            return true;
+        }
+    };
+#endif
+
+#if __cplusplus > 199711L
+    //
+    // Tag for constructing a value type directly inside its holder
+    //
+    template <typename T>
+    struct in_place_type_t
+    {
+        constexpr explicit in_place_type_t() {}
+    };
+#if __cplusplus >= 201402L
+    template <typename T>
+    constexpr in_place_type_t<T> in_place_type{};
+#endif
+#endif
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations;
+
+    template <typename Derived>
+    class forwarder;
+
+#if __cplusplus > 199711L
+    //
+    // Interface forwarding for any and any_ref; the arguments are forwarded
+    // straight through to the virtual call and const anys can call const functions
+    //
+    template <typename Derived>
+    class call_forwarding : public forwarder<Derived>
+    {
+    public:
+        template <typename R, typename C, typename... Params, typename... Args>
+        R call(R (C::*fn)(Params...), Args&&... args)
+        {
+            return (static_cast<Derived*>(this)->content->*fn)(std::forward<Args>(args)...);
+        }
+
+        template <typename R, typename C, typename... Params, typename... Args>
+        R call(R (C::*fn)(Params...) const, Args&&... args) const
+        {
+            return (static_cast<const Derived*>(this)->content->*fn)(std::forward<Args>(args)...);
+        }
+
+#if __cplusplus >= 201703L
+        // the function is a template argument, e.g. a.call<&Interface::f>(x),
+        // so the call compiles to a plain virtual call with no member pointer to decode
+        template <auto Fn, typename... Args>
+        decltype(auto) call(Args&&... args)
+        {
+            if constexpr (is_const_member_function<decltype(Fn)>::value)
+            {
+                return (static_cast<const Derived*>(this)->content->*Fn)(std::forward<Args>(args)...);
+            }
+            else
+            {
+                return (static_cast<Derived*>(this)->content->*Fn)(std::forward<Args>(args)...);
+            }
+        }
+
+        template <auto Fn, typename... Args>
+        decltype(auto) call(Args&&... args) const
+        {
+            static_assert(is_const_member_function<decltype(Fn)>::value, "only const functions can be called on a const any");
+            return (static_cast<const Derived*>(this)->content->*Fn)(std::forward<Args>(args)...);
+        }
+#endif
+    };
+#else
+    //
+    // Interface forwarding for any and any_ref, allow up to 10 params
+    //
+    template <typename Derived>
+    class call_forwarding : public forwarder<Derived>
+    {
+    public:
+        template <typename Function>
+        typename member_function_traits<Function>::result_type call(Function fn)
+        {
+            return (static_cast<Derived*>(this)->content->*fn)();
+        }
+
+        template <typename Function>
+        typename member_function_traits<Function>::result_type call(
+            Function fn,
+            typename member_function_traits<Function>::arg1_type t1)
+        {
+            return (static_cast<Derived*>(this)->content->*fn)(t1);
+        }
+
+        template <typename Function>
         typename member_function_traits<Function>::result_type call(
             Function fn,
             typename member_function_traits<Function>::arg1_type t1,
             typename member_function_traits<Function>::arg2_type t2)
         {
-            return (content->*fn)(t1, t2);
+            return (static_cast<Derived*>(this)->content->*fn)(t1, t2);
+        }
+
+        template <typename Function>
+        typename member_function_traits<Function>::result_type call(
+            Function fn,
+            typename member_function_traits<Function>::arg1_type t1,
+            typename member_function_traits<Function>::arg2_type t2,
+            typename member_function_traits<Function>::arg3_type t3)
+        {
+            return (static_cast<Derived*>(this)->content->*fn)(t1, t2, t3);
+        }
+
+        template <typename Function>
+        typename member_function_traits<Function>::result_type call(
+            Function fn,
+            typename member_function_traits<Function>::arg1_type t1,
+            typename member_function_traits<Function>::arg2_type t2,
+            typename member_function_traits<Function>::arg3_type t3,
+            typename member_function_traits<Function>::arg4_type t4)
+        {
+            return (static_cast<Derived*>(this)->content->*fn)(t1, t2, t3, t4);
+        }
+
+        template <typename Function>
+        typename member_function_traits<Function>::result_type call(
+            Function fn,
+            typename member_function_traits<Function>::arg1_type t1,
+            typename member_function_traits<Function>::arg2_type t2,
+            typename member_function_traits<Function>::arg3_type t3,
+            typename member_function_traits<Function>::arg4_type t4,
+            typename member_function_traits<Function>::arg5_type t5)
+        {
+            return (static_cast<Derived*>(this)->content->*fn)(t1, t2, t3, t4, t5);
+        }
+
+        template <typename Function>
+        typename member_function_traits<Function>::result_type call(
+            Function fn,
+            typename member_function_traits<Function>::arg1_type t1,
+            typename member_function_traits<Function>::arg2_type t2,
+            typename member_function_traits<Function>::arg3_type t3,
+            typename member_function_traits<Function>::arg4_type t4,
+            typename member_function_traits<Function>::arg5_type t5,
+            typename member_function_traits<Function>::arg6_type t6)
+        {
+            return (static_cast<Derived*>(this)->content->*fn)(t1, t2, t3, t4, t5, t6);
+        }
+
+        template <typename Function>
+        typename member_function_traits<Function>::result_type call(
+            Function fn,
+            typename member_function_traits<Function>::arg1_type t1,
+            typename member_function_traits<Function>::arg2_type t2,
+            typename member_function_traits<Function>::arg3_type t3,
+            typename member_function_traits<Function>::arg4_type t4,
+            typename member_function_traits<Function>::arg5_type t5,
+            typename member_function_traits<Function>::arg6_type t6,
+            typename member_function_traits<Function>::arg7_type t7)
+        {
+            return (static_cast<Derived*>(this)->content->*fn)(t1, t2, t3, t4, t5, t6, t7);
+        }
+
+        template <typename Function>
+        typename member_function_traits<Function>::result_type call(
+            Function fn,
+            typename member_function_traits<Function>::arg1_type t1,
+            typename member_function_traits<Function>::arg2_type t2,
+            typename member_function_traits<Function>::arg3_type t3,
+            typename member_function_traits<Function>::arg4_type t4,
+            typename member_function_traits<Function>::arg5_type t5,
+            typename member_function_traits<Function>::arg6_type t6,
+            typename member_function_traits<Function>::arg7_type t7,
+            typename member_function_traits<Function>::arg8_type t8)
+        {
+            return (static_cast<Derived*>(this)->content->*fn)(t1, t2, t3, t4, t5, t6, t7, t8);
+        }
+
+        template <typename Function>
+        typename member_function_traits<Function>::result_type call(
+            Function fn,
+            typename member_function_traits<Function>::arg1_type t1,
+            typename member_function_traits<Function>::arg2_type t2,
+            typename member_function_traits<Function>::arg3_type t3,
+            typename member_function_traits<Function>::arg4_type t4,
+            typename member_function_traits<Function>::arg5_type t5,
+            typename member_function_traits<Function>::arg6_type t6,
+            typename member_function_traits<Function>::arg7_type t7,
+            typename member_function_traits<Function>::arg8_type t8,
+            typename member_function_traits<Function>::arg9_type t9)
+        {
+            return (static_cast<Derived*>(this)->content->*fn)(t1, t2, t3, t4, t5, t6, t7, t8, t9);
+        }
+
+        template <typename Function>
+        typename member_function_traits<Function>::result_type call(
+            Function fn,
+            typename member_function_traits<Function>::arg1_type t1,
+            typename member_function_traits<Function>::arg2_type t2,
+            typename member_function_traits<Function>::arg3_type t3,
+            typename member_function_traits<Function>::arg4_type t4,
+            typename member_function_traits<Function>::arg5_type t5,
+            typename member_function_traits<Function>::arg6_type t6,
+            typename member_function_traits<Function>::arg7_type t7,
+            typename member_function_traits<Function>::arg8_type t8,
+            typename member_function_traits<Function>::arg9_type t9,
+            typename member_function_traits<Function>::arg10_type t10)
+        {
+            return (static_cast<Derived*>(this)->content->*fn)(t1, t2, t3, t4, t5, t6, t7, t8, t9, t10);
+        }
+    };
+#endif
+
+#if __cplusplus > 199711L
+    // only the listed interfaces are bases, so a holder has one vptr per interface
+    template <typename... Is>
+    struct interfaces : public Is...
+    {};
+#else
+    template <int N>
+    struct null_base { virtual ~null_base() {} };
+
+    template <typename I0 = null_base<0>,
+                typename I1 = null_base<1>,
+                typename I2 = null_base<2>,
+                typename I3 = null_base<3>,
+                typename I4 = null_base<4>,
+                typename I5 = null_base<5>,
+                typename I6 = null_base<6> >
+    struct interfaces : public I0, public I1, public I2, public I3, public I4, public I5, public I6
+    {};
+#endif
+
+    template <typename Interface, typename Comparable, typename Storage>
+    class any;
+
+    template <typename Interface, typename Comparable>
+    class any_ref;
+
+#if __cplusplus > 199711L
+    template <typename Interface, typename Comparable, typename Storage>
+    class unique_any;
+
+    template <typename Interface, typename Comparable>
+    class shared_any;
+
+    template <typename AnyType>
+    struct value_comparison;
+
+    template <typename AnyType>
+    struct bucket_sort;
+#endif
+
+    //
+    // Makes, hands over and destroys the holders of the anys. It's kept out
+    // of the anys so that its names can't hide forwarder functions, e.g. of
+    // an interface with a reset()
+    //
+    struct content_management
+    {
+#if __cplusplus > 199711L
+        template <typename Holder, typename... Args>
+        static Holder* construct(typename Holder::AnyType::StorageType& storage, Args&&... args)
+        {
+            void* p = storage.template allocate<Holder>();
+            try
+            {
+                return new (p) Holder(std::forward<Args>(args)...);
+            }
+#else
+        template <typename Holder, typename Arg>
+        static Holder* construct(typename Holder::AnyType::StorageType& storage, const Arg& arg)
+        {
+            void* p = storage.template allocate<Holder>();
+            try
+            {
+                return new (p) Holder(arg);
+            }
+#endif
+            catch(...)
+            {
+                storage.template deallocate<Holder>(p);
+                throw;
+            }
+        }
+
+        template <typename AnyType>
+        static void reset(AnyType& a)
+        {
+            if( a.content )
+            {
+                a.content->destroy(static_cast<typename AnyType::StorageType&>(a));
+                a.content = 0;
+            }
+        }
+
+        // take the holder from 'source', only moving it if it's in source's
+        // buffer or was allocated from storage 'target' can't free
+        template <typename AnyType>
+        static typename AnyType::placeholder* take(AnyType& target, AnyType& source)
+        {
+            typedef typename AnyType::StorageType Storage;
+            typename AnyType::placeholder* result = source.content;
+            if( result && (Storage::has_buffer || !static_cast<const Storage&>(target).can_adopt(source)) )
+            {
+                result = result->relocate(target, source);
+            }
+            source.content = 0;
+            return result;
+        }
+
+        // the old holder goes after the new one is in place (unless the new
+        // one needs the buffer), so if allocating it throws 'target' is unchanged
+        template <typename AnyType>
+        static void move_assign(AnyType& target, AnyType& source)
+        {
+            typedef typename AnyType::StorageType Storage;
+            if( Storage::has_buffer )
+            {
+                reset(target);
+                target.content = take(target, source);
+                return;
+            }
+            typename AnyType::placeholder* old = target.content;
+            target.content = take(target, source);
+            if( old )
+            {
+                old->destroy(static_cast<Storage&>(target));
+            }
+        }
+
+        // if the storages can't adopt each other's holders, both new holders
+        // are allocated before either old one goes, and one that's copied
+        // (because moving it could throw) is made first; so if anything
+        // throws both anys are unchanged, unless a move-only value's move
+        // constructor throws
+        template <typename AnyType>
+        static void swap(AnyType& a, AnyType& b)
+        {
+            typedef typename AnyType::StorageType Storage;
+            typedef typename AnyType::placeholder placeholder;
+            Storage& storageA = a;
+            Storage& storageB = b;
+            if( Storage::always_adopts || Storage::has_buffer || (storageA.can_adopt(storageB) && storageB.can_adopt(storageA)) )
+            {
+                AnyType tmp(static_cast<const Storage&>(a));
+                tmp.content = take(tmp, a);
+                a.content = take(a, b);
+                b.content = take(b, tmp);
+                return;
+            }
+
+            placeholder* fromA = a.content;
+            placeholder* fromB = b.content;
+            void* toA = fromB ? fromB->allocate_in(storageA) : 0;
+            void* toB = 0;
+            try
+            {
+                toB = fromA ? fromA->allocate_in(storageB) : 0;
+            }
+            catch(...)
+            {
+                if( toA ) fromB->deallocate_in(storageA, toA);
+                throw;
+            }
+
+            placeholder* newA = 0;
+            placeholder* newB = 0;
+            try
+            {
+                if( fromB && !fromB->transfers_nothrow() ) newA = fromB->transfer(toA);
+                if( fromA ) newB = fromA->transfer(toB);
+                if( fromB && !newA ) newA = fromB->transfer(toA);
+            }
+            catch(...)
+            {
+                if( newA ) newA->~placeholder();
+                if( toA ) fromB->deallocate_in(storageA, toA);
+                if( toB ) fromA->deallocate_in(storageB, toB);
+                throw;
+            }
+
+            if( fromA ) fromA->destroy(storageA);
+            if( fromB ) fromB->destroy(storageB);
+            a.content = newA;
+            b.content = newB;
+        }
+
+        template <typename I, typename C>
+        static bool refers_to_buffer(const any_ref<I, C>& r)
+        {
+            const char* p = reinterpret_cast<const char*>(r.content);
+            const char* buffer = reinterpret_cast<const char*>(&r.m_buffer);
+            return (p >= buffer && p < buffer + sizeof(r.m_buffer));
+        }
+
+        template <typename I, typename C>
+        static void assign(any_ref<I, C>& target, const any_ref<I, C>& source)
+        {
+            typedef typename any_ref<I, C>::placeholder placeholder;
+            if( refers_to_buffer(source) )
+            {
+                target.content = static_cast<const placeholder*>(source.content)->clone(&target.m_buffer);
+            }
+            else
+            {
+                target.content = source.content;
+            }
+        }
+
+        template <typename I, typename C>
+        static void reset(any_ref<I, C>& r)
+        {
+            typedef typename any_ref<I, C>::placeholder placeholder;
+            if( refers_to_buffer(r) )
+            {
+                static_cast<placeholder*>(r.content)->~placeholder();
+            }
+            r.content = 0;
+        }
+    };
+
+    template <typename Interface = interfaces<>, typename Comparable = less_than_equals_comparable, typename Storage = heap_storage>
+    class any : public call_forwarding<any<Interface,Comparable,Storage> >, private Storage
+    {
+        // CRTP base classes have access to 'content'
+        friend class forwarder<any>;
+        friend class call_forwarding<any>;
+#if __cplusplus > 199711L
+        friend class forwarding<any>;
+#endif
+        // and so does the holder management
+        friend struct content_management;
+        // and so do references to an any
+        template <typename I, typename C>
+        friend class any_ref;
+#if __cplusplus > 199711L
+        // and comparisons with raw values and sort_anys
+        friend struct value_comparison<any>;
+        friend struct bucket_sort<any>;
+#endif
+    public:
+        typedef any AnyType;
+        typedef Interface InterfaceType;
+        typedef Comparable ComparableType;
+        typedef Storage StorageType;
+    private:
+        class placeholder : public Comparable::template compare<Interface, placeholder>
+        {
+        public: // queries
+            // set by the holder, so reading it isn't a virtual call
+            type_info<any> type() const { return m_type; }
+            // told when the holder's value is in place, e.g. to cache a key
+            void constructed() {}
+            // copy into 'target', which may be the heap or its inline buffer
+            virtual placeholder* clone(Storage& target) const = 0;
+            // move from 'source' into 'target' (or just hand over the holder
+            // if it's on the heap and 'target' can free it)
+            virtual placeholder* relocate(Storage& target, Storage& source) = 0;
+            virtual void destroy(Storage& owner) = 0;
+            // for swapping with storage that can't adopt the holder: memory
+            // for it in 'target', then a new holder there, moved from this one
+            // if that can't throw and copied otherwise
+            virtual void* allocate_in(Storage& target) const = 0;
+            virtual void deallocate_in(Storage& target, void* p) const = 0;
+            virtual placeholder* transfer(void* p) = 0;
+            virtual bool transfers_nothrow() const = 0;
+
+        protected: // representation
+            type_info<any> m_type;
+        };
+
+    public:
+        //
+        // This has to be the most derived class so that 'clone' doesn't slice,
+        // so we use CRTP to enforce this condition
+        //
+        template<typename T>
+        class holder ANY_FACADE_FINAL : public value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T>
+        {
+            // CRTP base class has access to 'held'
+            friend class value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T>;
+            typedef value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T> OperationsType;
+        public: // structors
+            typedef any AnyType;
+            typedef T ValueType;
+
+            explicit holder(const ValueType & v)
+                : held(v)
+            {
+                this->m_type = type_info<any>::template type_id<ValueType>();
+                this->constructed();
+            }
+
+            holder(const holder & other)
+                : OperationsType(other), held(other.held)
+            {
+                // keys may refer into the value, so don't keep the other holder's
+                this->constructed();
+            }
+
+#if __cplusplus > 199711L
+            explicit holder(ValueType && v)
+                : held(std::move(v))
+            {
+                this->m_type = type_info<any>::template type_id<ValueType>();
+                this->constructed();
+            }
+
+            holder(holder && other) noexcept(std::is_nothrow_move_constructible<ValueType>::value)
+                : OperationsType(std::move(other)), held(std::move(other.held))
+            {
+                this->constructed();
+            }
+
+            template <typename... Args>
+            explicit holder(in_place_type_t<ValueType>, Args&&... args)
+                : held(std::forward<Args>(args)...)
+            {
+                this->m_type = type_info<any>::template type_id<ValueType>();
+                this->constructed();
+            }
+#endif
+
+        public: // queries
+
+            const ValueType& value() const { return held; }
+
+            virtual placeholder* clone(Storage& target) const
+            {
+                return content_management::construct<holder>(target, *this);
+            }
+            virtual placeholder* relocate(Storage& target, Storage& source)
+            {
+                if( Storage::template stores_inline<holder>::value || !target.can_adopt(source) )
+                {
+#if __cplusplus > 199711L
+                    placeholder* result = content_management::construct<holder>(target, std::move(*this));
+#else
+                    placeholder* result = content_management::construct<holder>(target, *this);
+#endif
+                    destroy(source);
+                    return result;
+                }
+                return this;
+            }
+            virtual void destroy(Storage& owner)
+            {
+                this->~holder();
+                owner.template deallocate<holder>(this);
+            }
+            virtual void* allocate_in(Storage& target) const
+            {
+                return target.template allocate<holder>();
+            }
+            virtual void deallocate_in(Storage& target, void* p) const
+            {
+                target.template deallocate<holder>(p);
+            }
+#if __cplusplus > 199711L
+            virtual placeholder* transfer(void* p)
+            {
+                return new (p) holder(std::move_if_noexcept(*this));
+            }
+            virtual bool transfers_nothrow() const
+            {
+                return std::is_nothrow_move_constructible<ValueType>::value;
+            }
+#else
+            virtual placeholder* transfer(void* p)
+            {
+                return new (p) holder(*this);
+            }
+            virtual bool transfers_nothrow() const
+            {
+                return false;
+            }
+#endif
+
+        private: // intentionally left unimplemented
+            holder & operator=(const holder &);
+
+        private: // representation
+
+            ValueType held;
+        };
+
+    public: // structors
+
+        any()
+            : content(0)
+        {
+        }
+
+        // an empty any whose values will use (a copy of) 'storage'
+        explicit any(const Storage & storage)
+            : Storage(storage), content(0)
+        {
+        }
+
+#if __cplusplus > 199711L
+        template<typename ValueType>
+        any(ValueType && value,
+            typename std::enable_if<!std::is_same<typename std::decay<ValueType>::type, any>::value &&
+                                    !std::is_same<typename std::decay<ValueType>::type, Storage>::value>::type* = 0)
+            : Storage(), content(content_management::construct<holder<typename std::decay<ValueType>::type> >(*this, std::forward<ValueType>(value)))
+        {
+        }
+
+        template<typename ValueType>
+        any(ValueType && value, const Storage & storage)
+            : Storage(storage), content(content_management::construct<holder<typename std::decay<ValueType>::type> >(*this, std::forward<ValueType>(value)))
+        {
+        }
+
+        // construct the value type from 'args' inside the holder, without a temporary
+        template<typename ValueType, typename... Args>
+        explicit any(in_place_type_t<ValueType>, Args&&... args)
+            : Storage(), content(content_management::construct<holder<ValueType> >(*this, in_place_type_t<ValueType>(), std::forward<Args>(args)...))
+        {
+        }
+#else
+        template<typename ValueType>
+        any(const ValueType & value)
+            : Storage(), content(content_management::construct<holder<ValueType> >(*this, value))
+        {
+        }
+
+        template<typename ValueType>
+        any(const ValueType & value, const Storage & storage)
+            : Storage(storage), content(content_management::construct<holder<ValueType> >(*this, value))
+        {
+        }
+#endif
+
+        any(const any & other)
+            : Storage(other), content(other.content ? other.content->clone(*this) : 0)
+        {
+        }
+
+#if __cplusplus > 199711L
+        any(any && other) noexcept
+            : Storage(other), content(content_management::take(*this, other))
+        {
+        }
+#endif
+
+        ~any()
+        {
+            content_management::reset(*this);
+        }
+
+    public: // modifiers
+
+        // only throws if the holders have to be moved into storage that can't
+        // adopt them, in which case both anys are unchanged
+#if __cplusplus > 199711L
+        any & swap(any & rhs) noexcept(Storage::always_adopts)
+#else
+        any & swap(any & rhs)
+#endif
+        {
+            content_management::swap(*this, rhs);
+            return *this;
+        }
+
+        any & operator=(const any & rhs)
+        {
+            // copy into our own storage, then swap
+            any tmp(static_cast<const Storage&>(*this));
+            tmp.content = rhs.content ? rhs.content->clone(tmp) : 0;
+            tmp.swap(*this);
+            return *this;
+        }
+
+#if __cplusplus > 199711L
+        // only throws if the holder has to be moved into storage that can't
+        // adopt it, in which case the any is unchanged
+        any & operator=(any && rhs) noexcept(Storage::always_adopts)
+        {
+            if( this != &rhs )
+            {
+                content_management::move_assign(*this, rhs);
+            }
+            return *this;
+        }
+
+        // replace the content with a value type constructed from 'args';
+        // if construction throws the any is left empty
+        template<typename ValueType, typename... Args>
+        void emplace(Args&&... args)
+        {
+            content_management::reset(*this);
+            content = content_management::construct<holder<ValueType> >(*this, in_place_type_t<ValueType>(), std::forward<Args>(args)...);
+        }
+#endif
+
+    public: // queries
+
+        bool empty() const
+        {
+            return !content;
+        }
+
+    public: // comparisons
+        // equality
+        friend bool operator==(const any& lhs, const any& rhs)
+        {
+            return lhs.content->equals(*rhs.content);
+        }
+        friend bool operator!=(const any& lhs, const any& rhs) {return !static_cast<bool>(lhs == rhs);}
+
+        // less than comparable
+        friend bool operator<(const any& lhs, const any& rhs)
+        {
+            return lhs.content->less(*rhs.content);
+        }
+        friend bool operator>(const any& lhs, const any& rhs)  { return rhs < lhs; }
+        friend bool operator<=(const any& lhs, const any& rhs) { return !static_cast<bool>(rhs < lhs); }
+        friend bool operator>=(const any& lhs, const any& rhs) { return !static_cast<bool>(lhs < rhs); }
+
+
+#ifdef ANY_FACADE_HAS_THREE_WAY_COMPARISON
+        // three way comparable
+        friend std::weak_ordering operator<=>(const any& lhs, const any& rhs)
+        {
+            return lhs.content->compare_to(*rhs.content) <=> 0;
+        }
+#endif
+
+#if __cplusplus > 199711L
+        // hashable (used by std::hash)
+        friend std::size_t hash_value(const any& a)
+        {
+            return a.content->hash();
+        }
+#endif
+
+    private: // types
+
+    private: // representation
+
+        placeholder* content;
+    };
+
+#if __cplusplus > 199711L
+    //
+    // Whether a comparability orders anys by type and then by value, so values
+    // of different types never need comparing; 'holders' has one of each type.
+    // Only type_ordered comparabilities say so...
+    //
+    // equals(), less() and greater() compare a placeholder with a raw value
+    // of a different type
+    //
+    template <typename Comparable>
+    struct orders_by_type : public std::false_type
+    {
+    };
+    struct type_then_value_order : public std::true_type
+    {
+        template <typename AnyType, typename Placeholder>
+        static bool between(const std::vector<const Placeholder*>&) { return true; }
+
+        template <typename AnyType, typename Placeholder, typename T>
+        static bool equals(const Placeholder&, const T&)
+        {
+            return false;
+        }
+        template <typename AnyType, typename Placeholder, typename T>
+        static bool less(const Placeholder& lhs, const T&)
+        {
+            return lhs.type() < type_info<AnyType>::template type_id<T>();
+        }
+        template <typename AnyType, typename Placeholder, typename T>
+        static bool greater(const Placeholder& lhs, const T&)
+        {
+            return type_info<AnyType>::template type_id<T>() < lhs.type();
+        }
+    };
+    template <> struct orders_by_type<type_ordered<less_than_comparable> > : public type_then_value_order {};
+    template <> struct orders_by_type<type_ordered<less_than_equals_comparable> > : public type_then_value_order {};
+    template <> struct orders_by_type<type_ordered<three_way_comparable> > : public type_then_value_order {};
+
+    // ...unless a function has been registered between two of the types
+    struct registered_cross_type_order : public type_then_value_order
+    {
+        template <typename AnyType, typename Placeholder>
+        static bool between(const std::vector<const Placeholder*>& holders)
+        {
+            typedef binary_dispatch<AnyType, less_than_comparable> table;
+            for( std::size_t i = 0; i < holders.size(); ++i )
+            {
+                for( std::size_t j = 0; j < holders.size(); ++j )
+                {
+                    if( i != j && table::find(holders[i]->ordinal(), holders[j]->ordinal()) ) return false;
+                }
+            }
+            return true;
+        }
+
+        template <typename AnyType, typename Placeholder, typename T>
+        static bool equals(const Placeholder& lhs, const T& rhs)
+        {
+            typedef binary_dispatch<AnyType, equality_comparable> table;
+            typename table::function_type fn = table::find(lhs.ordinal(), type_ordinals<AnyType>::template of<T>(), table::lhs_held);
+            return fn ? fn(&lhs, &rhs) : false;
+        }
+        template <typename AnyType, typename Placeholder, typename T>
+        static bool less(const Placeholder& lhs, const T& rhs)
+        {
+            typedef binary_dispatch<AnyType, less_than_comparable> table;
+            typename table::function_type fn = table::find(lhs.ordinal(), type_ordinals<AnyType>::template of<T>(), table::lhs_held);
+            return fn ? fn(&lhs, &rhs) : type_then_value_order::less<AnyType>(lhs, rhs);
+        }
+        template <typename AnyType, typename Placeholder, typename T>
+        static bool greater(const Placeholder& lhs, const T& rhs)
+        {
+            typedef binary_dispatch<AnyType, less_than_comparable> table;
+            typename table::function_type fn = table::find(type_ordinals<AnyType>::template of<T>(), lhs.ordinal(), table::rhs_held);
+            return fn ? fn(&rhs, &lhs) : type_then_value_order::greater<AnyType>(lhs, rhs);
+        }
+    };
+    template <> struct orders_by_type<type_ordered<cross_type_comparable<less_than_comparable> > > : public registered_cross_type_order {};
+    template <> struct orders_by_type<type_ordered<cross_type_comparable<less_than_equals_comparable> > > : public registered_cross_type_order {};
+
+    //
+    // Compares an any with a raw value without making an any from it. If the
+    // comparability is type_ordered, a value of the held type is compared
+    // with it directly and a value of another type is ordered by type id (or
+    // a function registered in binary_dispatch). Otherwise value_type_operations
+    // may override equals or less, so the value is copied into a holder on the
+    // stack and compared like an any. Values decay as they do when making an
+    // any, e.g. a string literal is a const char*...
+    //
+    template <typename I, typename C, typename S>
+    struct value_comparison<any<I, C, S> >
+    {
+        typedef any<I, C, S> AnyType;
+
+        template <typename T>
+        static bool equals(const AnyType& lhs, const T& rhs)
+        {
+            return equals<typename std::decay<const T&>::type>(lhs, rhs, orders_by_type<C>());
+        }
+        template <typename T>
+        static bool less(const AnyType& lhs, const T& rhs)
+        {
+            return less<typename std::decay<const T&>::type>(lhs, rhs, orders_by_type<C>());
+        }
+        template <typename T>
+        static bool less(const T& lhs, const AnyType& rhs)
+        {
+            return greater<typename std::decay<const T&>::type>(rhs, lhs, orders_by_type<C>());
+        }
+
+    private:
+        template <typename V>
+        static const V& held(const AnyType& a)
+        {
+            return static_cast<const typename AnyType::template holder<V>*>(a.content)->value();
+        }
+
+        template <typename V>
+        static bool equals(const AnyType& lhs, const V& rhs, const std::false_type&)
+        {
+            return lhs.content->equals(typename AnyType::template holder<V>(rhs));
+        }
+        template <typename V>
+        static bool less(const AnyType& lhs, const V& rhs, const std::false_type&)
+        {
+            return lhs.content->less(typename AnyType::template holder<V>(rhs));
+        }
+        // rhs < lhs
+        template <typename V>
+        static bool greater(const AnyType& lhs, const V& rhs, const std::false_type&)
+        {
+            return typename AnyType::template holder<V>(rhs).less(*lhs.content);
+        }
+
+        template <typename V>
+        static bool equals(const AnyType& lhs, const V& rhs, const std::true_type&)
+        {
+            if( lhs.content->type() == type_info<AnyType>::template type_id<V>() )
+            {
+                return C::equals(held<V>(lhs), rhs);
+            }
+            return orders_by_type<C>::template equals<AnyType>(*lhs.content, rhs);
+        }
+        template <typename V>
+        static bool less(const AnyType& lhs, const V& rhs, const std::true_type&)
+        {
+            if( lhs.content->type() == type_info<AnyType>::template type_id<V>() )
+            {
+                return C::less(held<V>(lhs), rhs);
+            }
+            return orders_by_type<C>::template less<AnyType>(*lhs.content, rhs);
+        }
+        template <typename V>
+        static bool greater(const AnyType& lhs, const V& rhs, const std::true_type&)
+        {
+            if( lhs.content->type() == type_info<AnyType>::template type_id<V>() )
+            {
+                return C::less(rhs, held<V>(lhs));
+            }
+            return orders_by_type<C>::template greater<AnyType>(*lhs.content, rhs);
+        }
+    };
+
+    template <typename I, typename C, typename S, typename T>
+    typename std::enable_if<!is_any<T>::value, bool>::type operator==(const any<I, C, S>& lhs, const T& rhs) { return value_comparison<any<I, C, S> >::equals(lhs, rhs); }
+    template <typename I, typename C, typename S, typename T>
+    typename std::enable_if<!is_any<T>::value, bool>::type operator==(const T& lhs, const any<I, C, S>& rhs) { return value_comparison<any<I, C, S> >::equals(rhs, lhs); }
+    template <typename I, typename C, typename S, typename T>
+    typename std::enable_if<!is_any<T>::value, bool>::type operator!=(const any<I, C, S>& lhs, const T& rhs) { return !value_comparison<any<I, C, S> >::equals(lhs, rhs); }
+    template <typename I, typename C, typename S, typename T>
+    typename std::enable_if<!is_any<T>::value, bool>::type operator!=(const T& lhs, const any<I, C, S>& rhs) { return !value_comparison<any<I, C, S> >::equals(rhs, lhs); }
+    template <typename I, typename C, typename S, typename T>
+    typename std::enable_if<!is_any<T>::value, bool>::type operator<(const any<I, C, S>& lhs, const T& rhs) { return value_comparison<any<I, C, S> >::less(lhs, rhs); }
+    template <typename I, typename C, typename S, typename T>
+    typename std::enable_if<!is_any<T>::value, bool>::type operator<(const T& lhs, const any<I, C, S>& rhs) { return value_comparison<any<I, C, S> >::less(lhs, rhs); }
+    template <typename I, typename C, typename S, typename T>
+    typename std::enable_if<!is_any<T>::value, bool>::type operator>(const any<I, C, S>& lhs, const T& rhs) { return value_comparison<any<I, C, S> >::less(rhs, lhs); }
+    template <typename I, typename C, typename S, typename T>
+    typename std::enable_if<!is_any<T>::value, bool>::type operator>(const T& lhs, const any<I, C, S>& rhs) { return value_comparison<any<I, C, S> >::less(rhs, lhs); }
+    template <typename I, typename C, typename S, typename T>
+    typename std::enable_if<!is_any<T>::value, bool>::type operator<=(const any<I, C, S>& lhs, const T& rhs) { return !value_comparison<any<I, C, S> >::less(rhs, lhs); }
+    template <typename I, typename C, typename S, typename T>
+    typename std::enable_if<!is_any<T>::value, bool>::type operator<=(const T& lhs, const any<I, C, S>& rhs) { return !value_comparison<any<I, C, S> >::less(rhs, lhs); }
+    template <typename I, typename C, typename S, typename T>
+    typename std::enable_if<!is_any<T>::value, bool>::type operator>=(const any<I, C, S>& lhs, const T& rhs) { return !value_comparison<any<I, C, S> >::less(lhs, rhs); }
+    template <typename I, typename C, typename S, typename T>
+    typename std::enable_if<!is_any<T>::value, bool>::type operator>=(const T& lhs, const any<I, C, S>& rhs) { return !value_comparison<any<I, C, S> >::less(lhs, rhs); }
+
+    template <typename AnyType>
+    struct bucket_sort
+    {
+        typedef typename AnyType::ComparableType C;
+        typedef typename AnyType::placeholder Placeholder;
+
+        struct bucket
+        {
+            type_info<AnyType> type;
+            std::size_t begin;
+            std::size_t size;
+        };
+        struct bucket_type_less
+        {
+            explicit bucket_type_less(const std::vector<bucket>& buckets) : buckets(buckets) {}
+            bool operator()(std::size_t lhs, std::size_t rhs) const
+            {
+                return buckets[lhs].type < buckets[rhs].type;
+            }
+            const std::vector<bucket>& buckets;
+        };
+
+        template <typename RandomIt>
+        static void sort(RandomIt first, RandomIt last)
+        {
+            sort(first, last, orders_by_type<C>());
+        }
+
+    private:
+        static const Placeholder* placeholder_of(Placeholder* p) { return p; }
+        template <typename Content>
+        static const Placeholder* placeholder_of(const Content& c) { return c.get(); }
+
+        template <typename RandomIt>
+        static void sort(RandomIt first, RandomIt last, const std::false_type&)
+        {
+            std::sort(first, last);
+        }
+
+        template <typename RandomIt>
+        static void sort(RandomIt first, RandomIt last, const std::true_type&)
+        {
+            const std::size_t count = static_cast<std::size_t>(last - first);
+            std::vector<const Placeholder*> holders(count);
+            std::vector<std::size_t> bucketOf(count);
+            std::vector<bucket> buckets;
+            std::vector<const Placeholder*> examples;
+
+            // one pass over the cached type ids to find each value's bucket;
+            // there are usually few types, and runs of the same one
+            std::size_t current = 0;
+            for( std::size_t i = 0; i < count; ++i )
+            {
+                holders[i] = placeholder_of(first[i].content);
+                const type_info<AnyType> type = holders[i]->type();
+                if( buckets.empty() || !(buckets[current].type == type) )
+                {
+                    current = 0;
+                    while( current < buckets.size() && !(buckets[current].type == type) ) ++current;
+                    if( current == buckets.size() )
+                    {
+                        const bucket b = { type, 0, 0 };
+                        buckets.push_back(b);
+                        examples.push_back(holders[i]);
+                    }
+                }
+                ++buckets[current].size;
+                bucketOf[i] = current;
+            }
+
+            if( !orders_by_type<C>::template between<AnyType>(examples) )
+            {
+                std::sort(first, last);
+                return;
+            }
+
+            // lay the buckets out in type order...
+            std::vector<std::size_t> byType(buckets.size());
+            for( std::size_t b = 0; b < buckets.size(); ++b ) byType[b] = b;
+            std::sort(byType.begin(), byType.end(), bucket_type_less(buckets));
+            std::size_t begin = 0;
+            for( std::size_t b = 0; b < byType.size(); ++b )
+            {
+                buckets[byType[b]].begin = begin;
+                begin += buckets[byType[b]].size;
+            }
+            std::vector<std::size_t> order(count);
+            std::vector<std::size_t> next(buckets.size());
+            for( std::size_t b = 0; b < buckets.size(); ++b ) next[b] = buckets[b].begin;
+            for( std::size_t i = 0; i < count; ++i ) order[next[bucketOf[i]]++] = i;
+            std::vector<std::size_t>().swap(bucketOf);
+
+            // ...then sort each one with a single virtual call
+            for( std::size_t b = 0; b < buckets.size(); ++b )
+            {
+                std::size_t* bucketBegin = order.data() + buckets[b].begin;
+                examples[b]->sort_same_type(holders.data(), bucketBegin, bucketBegin + buckets[b].size);
+            }
+
+            // ...and put the anys in that order in place, following each
+            // cycle of the permutation ('order' marks where it's been)
+            for( std::size_t i = 0; i < count; ++i )
+            {
+                std::size_t j = i;
+                while( order[j] != i )
+                {
+                    const std::size_t k = order[j];
+                    std::iter_swap(first + j, first + k);
+                    order[j] = j;
+                    j = k;
+                }
+                order[j] = j;
+            }
+        }
+    };
+
+    //
+    // Sorts a range of anys into the same order as std::sort(first, last), but
+    // with one virtual call per value type rather than per comparison: values
+    // are put in buckets by their cached type id, then each bucket is sorted
+    // with its value type's less. Only anys whose comparability is
+    // type_ordered are sorted in buckets; others, and ranges where values of
+    // different types are ordered between each other (e.g. cross type less
+    // registered in binary_dispatch), use std::sort. The anys may be anys,
+    // unique_anys or shared_anys, and are swapped into place, so there's
+    // no second copy of the range.
+    //
+    template <typename RandomIt>
+    void sort_anys(RandomIt first, RandomIt last)
+    {
+        bucket_sort<typename std::iterator_traits<RandomIt>::value_type>::sort(first, last);
+    }
+#endif
+
+#if __cplusplus > 199711L
+    //
+    // A move only any; value types only have to be movable, so there's no
+    // clone and moving hands over the holder
+    //
+    template <typename Interface = interfaces<>, typename Comparable = not_comparable, typename Storage = heap_storage>
+    class unique_any : public call_forwarding<unique_any<Interface,Comparable,Storage> >, private Storage
+    {
+        // CRTP base classes have access to 'content'
+        friend class forwarder<unique_any>;
+        friend class call_forwarding<unique_any>;
+        friend class forwarding<unique_any>;
+        // and so does the holder management
+        friend struct content_management;
+        // and so do references to a unique_any
+        template <typename I, typename C>
+        friend class any_ref;
+        // and sort_anys
+        friend struct bucket_sort<unique_any>;
+    public:
+        typedef unique_any AnyType;
+        typedef Interface InterfaceType;
+        typedef Comparable ComparableType;
+        typedef Storage StorageType;
+    private:
+        class placeholder : public Comparable::template compare<Interface, placeholder>
+        {
+        public: // queries
+            // set by the holder, so reading it isn't a virtual call
+            type_info<unique_any> type() const { return m_type; }
+            // told when the holder's value is in place, e.g. to cache a key
+            void constructed() {}
+            // move from 'source' into 'target' (or just hand over the holder
+            // if it's on the heap and 'target' can free it)
+            virtual placeholder* relocate(Storage& target, Storage& source) = 0;
+            virtual void destroy(Storage& owner) = 0;
+            // for swapping with storage that can't adopt the holder: memory
+            // for it in 'target', then a new holder there, moved from this one
+            // if that can't throw and copied otherwise
+            virtual void* allocate_in(Storage& target) const = 0;
+            virtual void deallocate_in(Storage& target, void* p) const = 0;
+            virtual placeholder* transfer(void* p) = 0;
+            virtual bool transfers_nothrow() const = 0;
+
+        protected: // representation
+            type_info<unique_any> m_type;
+        };
+    public:
+        //
+        // This has to be the most derived class so that 'relocate' doesn't slice,
+        // so we use CRTP to enforce this condition
+        //
+        template<typename T>
+        class holder ANY_FACADE_FINAL : public value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T>
+        {
+            // CRTP base class has access to 'held'
+            friend class value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T>;
+            typedef value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T> OperationsType;
+        public: // structors
+            typedef unique_any AnyType;
+            typedef T ValueType;
+
+            explicit holder(const ValueType & v)
+                : held(v)
+            {
+                this->m_type = type_info<unique_any>::template type_id<ValueType>();
+                this->constructed();
+            }
+
+            explicit holder(ValueType && v)
+                : held(std::move(v))
+            {
+                this->m_type = type_info<unique_any>::template type_id<ValueType>();
+                this->constructed();
+            }
+
+            template <typename... Args>
+            explicit holder(in_place_type_t<ValueType>, Args&&... args)
+                : held(std::forward<Args>(args)...)
+            {
+                this->m_type = type_info<unique_any>::template type_id<ValueType>();
+                this->constructed();
+            }
+
+            holder(holder && other) noexcept(std::is_nothrow_move_constructible<ValueType>::value)
+                : OperationsType(std::move(other)), held(std::move(other.held))
+            {
+                this->constructed();
+            }
+
+        public: // queries
+
+            const ValueType& value() const { return held; }
+
+            virtual placeholder* relocate(Storage& target, Storage& source)
+            {
+                if( Storage::template stores_inline<holder>::value || !target.can_adopt(source) )
+                {
+                    placeholder* result = content_management::construct<holder>(target, std::move(*this));
+                    destroy(source);
+                    return result;
+                }
+                return this;
+            }
+            virtual void destroy(Storage& owner)
+            {
+                this->~holder();
+                owner.template deallocate<holder>(this);
+            }
+            virtual void* allocate_in(Storage& target) const
+            {
+                return target.template allocate<holder>();
+            }
+            virtual void deallocate_in(Storage& target, void* p) const
+            {
+                target.template deallocate<holder>(p);
+            }
+            virtual placeholder* transfer(void* p)
+            {
+                return new (p) holder(std::move(*this));
+            }
+            virtual bool transfers_nothrow() const
+            {
+                return std::is_nothrow_move_constructible<ValueType>::value;
+            }
+
+        private: // not copyable
+            holder(const holder &) = delete;
+            holder & operator=(const holder &) = delete;
+
+        private: // representation
+
+            ValueType held;
+        };
+
+    public: // structors
+
+        unique_any()
+            : content(0)
+        {
+        }
+
+        // an empty unique_any whose values will use (a copy of) 'storage'
+        explicit unique_any(const Storage & storage)
+            : Storage(storage), content(0)
+        {
+        }
+
+        template<typename ValueType>
+        unique_any(ValueType && value,
+            typename std::enable_if<!std::is_same<typename std::decay<ValueType>::type, unique_any>::value &&
+                                    !std::is_same<typename std::decay<ValueType>::type, Storage>::value>::type* = 0)
+            : Storage(), content(content_management::construct<holder<typename std::decay<ValueType>::type> >(*this, std::forward<ValueType>(value)))
+        {
+        }
+
+        template<typename ValueType>
+        unique_any(ValueType && value, const Storage & storage)
+            : Storage(storage), content(content_management::construct<holder<typename std::decay<ValueType>::type> >(*this, std::forward<ValueType>(value)))
+        {
+        }
+
+        // construct the value type from 'args' inside the holder, without a temporary
+        template<typename ValueType, typename... Args>
+        explicit unique_any(in_place_type_t<ValueType>, Args&&... args)
+            : Storage(), content(content_management::construct<holder<ValueType> >(*this, in_place_type_t<ValueType>(), std::forward<Args>(args)...))
+        {
+        }
+
+        unique_any(unique_any && other) noexcept
+            : Storage(other), content(content_management::take(*this, other))
+        {
+        }
+
+        unique_any(const unique_any &) = delete;
+
+        ~unique_any()
+        {
+            content_management::reset(*this);
+        }
+
+    public: // modifiers
+
+        // only throws if the holders have to be moved into storage that can't
+        // adopt them, in which case both unique_anys are unchanged (unless
+        // moving a value throws)
+        unique_any & swap(unique_any & rhs) noexcept(Storage::always_adopts)
+        {
+            content_management::swap(*this, rhs);
+            return *this;
+        }
+
+        // only throws if the holder has to be moved into storage that can't
+        // adopt it, in which case the unique_any is unchanged
+        unique_any & operator=(unique_any && rhs) noexcept(Storage::always_adopts)
+        {
+            if( this != &rhs )
+            {
+                content_management::move_assign(*this, rhs);
+            }
+            return *this;
+        }
+
+        unique_any & operator=(const unique_any &) = delete;
+
+        // replace the content with a value type constructed from 'args';
+        // if construction throws the unique_any is left empty
+        template<typename ValueType, typename... Args>
+        void emplace(Args&&... args)
+        {
+            content_management::reset(*this);
+            content = content_management::construct<holder<ValueType> >(*this, in_place_type_t<ValueType>(), std::forward<Args>(args)...);
+        }
+
+    public: // queries
+
+        bool empty() const
+        {
+            return !content;
+        }
+
+    public: // comparisons
+        // equality
+        friend bool operator==(const unique_any& lhs, const unique_any& rhs)
+        {
+            return lhs.content->equals(*rhs.content);
+        }
+        friend bool operator!=(const unique_any& lhs, const unique_any& rhs) {return !static_cast<bool>(lhs == rhs);}
+
+        // less than comparable
+        friend bool operator<(const unique_any& lhs, const unique_any& rhs)
+        {
+            return lhs.content->less(*rhs.content);
+        }
+        friend bool operator>(const unique_any& lhs, const unique_any& rhs)  { return rhs < lhs; }
+        friend bool operator<=(const unique_any& lhs, const unique_any& rhs) { return !static_cast<bool>(rhs < lhs); }
+        friend bool operator>=(const unique_any& lhs, const unique_any& rhs) { return !static_cast<bool>(lhs < rhs); }
+
+#ifdef ANY_FACADE_HAS_THREE_WAY_COMPARISON
+        // three way comparable
+        friend std::weak_ordering operator<=>(const unique_any& lhs, const unique_any& rhs)
+        {
+            return lhs.content->compare_to(*rhs.content) <=> 0;
+        }
+#endif
+
+#if __cplusplus > 199711L
+        // hashable (used by std::hash)
+        friend std::size_t hash_value(const unique_any& a)
+        {
+            return a.content->hash();
+        }
+#endif
+
+    private: // representation
+
+        placeholder* content;
+    };
+
+    //
+    // An any whose copies share one immutable holder through an atomic
+    // reference count; calling a non-const interface function on a shared
+    // holder first makes a private copy (copy on write)
+    //
+    template <typename Interface = interfaces<>, typename Comparable = less_than_equals_comparable>
+    class shared_any : public call_forwarding<shared_any<Interface,Comparable> >
+    {
+        // CRTP base classes have access to 'content'
+        friend class forwarder<shared_any>;
+        friend class call_forwarding<shared_any>;
+        friend class forwarding<shared_any>;
+        // and so does sort_anys
+        friend struct bucket_sort<shared_any>;
+    public:
+        typedef shared_any AnyType;
+        typedef Interface InterfaceType;
+        typedef Comparable ComparableType;
+    private:
+        class placeholder : public Comparable::template compare<Interface, placeholder>
+        {
+        public: // structors
+            placeholder()
+                : references(1)
+            {
+            }
+            // a copy starts off unshared
+            placeholder(const placeholder & other)
+                : Comparable::template compare<Interface, placeholder>(other), references(1), m_type(other.m_type)
+            {
+            }
+            virtual ~placeholder() {}
+
+        public: // queries
+            // set by the holder, so reading it isn't a virtual call
+            type_info<shared_any> type() const { return m_type; }
+            // told when the holder's value is in place, e.g. to cache a key
+            void constructed() {}
+            virtual placeholder* clone() const = 0;
+
+        public: // reference counting
+            void add_reference() const
+            {
+                references.fetch_add(1, std::memory_order_relaxed);
+            }
+            void release() const
+            {
+                if( references.fetch_sub(1, std::memory_order_acq_rel) == 1 )
+                {
+                    delete this;
+                }
+            }
+            long use_count() const
+            {
+                return references.load(std::memory_order_acquire);
+            }
+
+        private: // representation
+            mutable std::atomic<long> references;
+
+        protected: // representation
+            type_info<shared_any> m_type;
+        };
+
+        //
+        // What the forwarders see as 'content': const access reads the shared
+        // holder, non-const access makes sure it isn't shared first
+        //
+        class shared_content
+        {
+        public:
+            explicit shared_content(placeholder* p = 0)
+                : held(p)
+            {
+            }
+
+            const placeholder* operator->() const { return held; }
+            placeholder* operator->() { return unshare(); }
+
+            operator const placeholder*() const { return held; }
+            operator placeholder*() { return unshare(); }
+
+            const placeholder* get() const { return held; }
+
+        private:
+            friend class shared_any;
+
+            placeholder* unshare()
+            {
+                if( held && held->use_count() != 1 )
+                {
+                    placeholder* copy = held->clone();
+                    held->release();
+                    held = copy;
+                }
+                return held;
+            }
+
+            placeholder* held;
+        };
+
+    public:
+        //
+        // This has to be the most derived class so that 'clone' doesn't slice,
+        // so we use CRTP to enforce this condition
+        //
+        template<typename T>
+        class holder ANY_FACADE_FINAL : public value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T>
+        {
+            // CRTP base class has access to 'held'
+            friend class value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T>;
+        public: // structors
+            typedef shared_any AnyType;
+            typedef T ValueType;
+
+            explicit holder(const ValueType & v)
+                : held(v)
+            {
+                this->m_type = type_info<shared_any>::template type_id<ValueType>();
+                this->constructed();
+            }
+
+            explicit holder(ValueType && v)
+                : held(std::move(v))
+            {
+                this->m_type = type_info<shared_any>::template type_id<ValueType>();
+                this->constructed();
+            }
+
+            template <typename... Args>
+            explicit holder(in_place_type_t<ValueType>, Args&&... args)
+                : held(std::forward<Args>(args)...)
+            {
+                this->m_type = type_info<shared_any>::template type_id<ValueType>();
+                this->constructed();
+            }
+
+            holder(const holder & other)
+                : value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T>(other), held(other.held)
+            {
+                this->constructed();
+            }
+
+        public: // queries
+
+            const ValueType& value() const { return held; }
+
+            virtual placeholder* clone() const
+            {
+                return new holder(*this);
+            }
+
+        private: // intentionally left unimplemented
+            holder & operator=(const holder &);
+
+        private: // representation
+
+            ValueType held;
+        };
+
+    public: // structors
+
+        shared_any()
+        {
         }
 
-        template <typename Function>
-        typename member_function_traits<Function>::result_type call(
-            Function fn,
-            typename member_function_traits<Function>::arg1_type t1,
-            typename member_function_traits<Function>::arg2_type t2,
-            typename member_function_traits<Function>::arg3_type t3)
+        template<typename ValueType>
+        shared_any(ValueType && value,
+            typename std::enable_if<!std::is_same<typename std::decay<ValueType>::type, shared_any>::value>::type* = 0)
+            : content(new holder<typename std::decay<ValueType>::type>(std::forward<ValueType>(value)))
         {
-            return (content->*fn)(t1, t2, t3);
         }
 
-        template <typename Function>
-        typename member_function_traits<Function>::result_type call(
-            Function fn,
-            typename member_function_traits<Function>::arg1_type t1,
-            typename member_function_traits<Function>::arg2_type t2,
-            typename member_function_traits<Function>::arg3_type t3,
-            typename member_function_traits<Function>::arg4_type t4)
+        // construct the value type from 'args' inside the holder, without a temporary
+        template<typename ValueType, typename... Args>
+        explicit shared_any(in_place_type_t<ValueType>, Args&&... args)
+            : content(new holder<ValueType>(in_place_type_t<ValueType>(), std::forward<Args>(args)...))
         {
-            return (content->*fn)(t1, t2, t3, t4);
         }
 
-        template <typename Function>
-        typename member_function_traits<Function>::result_type call(
-            Function fn,
-            typename member_function_traits<Function>::arg1_type t1,
-            typename member_function_traits<Function>::arg2_type t2,
-            typename member_function_traits<Function>::arg3_type t3,
-            typename member_function_traits<Function>::arg4_type t4,
-            typename member_function_traits<Function>::arg5_type t5)
+        // share the holder of 'other'
+        shared_any(const shared_any & other)
+            : content(other.content.held)
         {
-            return (content->*fn)(t1, t2, t3, t4, t5);
+            if( content.held )
+            {
+                content.held->add_reference();
+            }
         }
 
-        template <typename Function>
-        typename member_function_traits<Function>::result_type call(
-            Function fn,
-            typename member_function_traits<Function>::arg1_type t1,
-            typename member_function_traits<Function>::arg2_type t2,
-            typename member_function_traits<Function>::arg3_type t3,
-            typename member_function_traits<Function>::arg4_type t4,
-            typename member_function_traits<Function>::arg5_type t5,
-            typename member_function_traits<Function>::arg6_type t6)
+        shared_any(shared_any && other) noexcept
+            : content(other.content.held)
         {
-            return (content->*fn)(t1, t2, t3, t4, t5, t6);
+            other.content.held = 0;
         }
 
-        template <typename Function>
-        typename member_function_traits<Function>::result_type call(
-            Function fn,
-            typename member_function_traits<Function>::arg1_type t1,
-            typename member_function_traits<Function>::arg2_type t2,
-            typename member_function_traits<Function>::arg3_type t3,
-            typename member_function_traits<Function>::arg4_type t4,
-            typename member_function_traits<Function>::arg5_type t5,
-            typename member_function_traits<Function>::arg6_type t6,
-            typename member_function_traits<Function>::arg7_type t7)
+        ~shared_any()
+        {
+            if( content.held )
+            {
+                content.held->release();
+            }
+        }
+
+    public: // modifiers
+
+        shared_any & swap(shared_any & rhs) noexcept
         {
-            return (content->*fn)(t1, t2, t3, t4, t5, t6, t7);
+            std::swap(content.held, rhs.content.held);
+            return *this;
         }
 
-        template <typename Function>
-        typename member_function_traits<Function>::result_type call(
-            Function fn,
-            typename member_function_traits<Function>::arg1_type t1,
-            typename member_function_traits<Function>::arg2_type t2,
-            typename member_function_traits<Function>::arg3_type t3,
-            typename member_function_traits<Function>::arg4_type t4,
-            typename member_function_traits<Function>::arg5_type t5,
-            typename member_function_traits<Function>::arg6_type t6,
-            typename member_function_traits<Function>::arg7_type t7,
-            typename member_function_traits<Function>::arg8_type t8)
+        shared_any & operator=(const shared_any & rhs)
         {
-            return (content->*fn)(t1, t2, t3, t4, t5, t6, t7, t8);
+            shared_any(rhs).swap(*this);
+            return *this;
         }
 
-        template <typename Function>
-        typename member_function_traits<Function>::result_type call(
-            Function fn,
-            typename member_function_traits<Function>::arg1_type t1,
-            typename member_function_traits<Function>::arg2_type t2,
-            typename member_function_traits<Function>::arg3_type t3,
-            typename member_function_traits<Function>::arg4_type t4,
-            typename member_function_traits<Function>::arg5_type t5,
-            typename member_function_traits<Function>::arg6_type t6,
-            typename member_function_traits<Function>::arg7_type t7,
-            typename member_function_traits<Function>::arg8_type t8,
-            typename member_function_traits<Function>::arg9_type t9)
+        shared_any & operator=(shared_any && rhs) noexcept
         {
-            return (content->*fn)(t1, t2, t3, t4, t5, t6, t7, t8, t9);
+            shared_any(std::move(rhs)).swap(*this);
+            return *this;
         }
 
-        template <typename Function>
-        typename member_function_traits<Function>::result_type call(
-            Function fn,
-            typename member_function_traits<Function>::arg1_type t1,
-            typename member_function_traits<Function>::arg2_type t2,
-            typename member_function_traits<Function>::arg3_type t3,
-            typename member_function_traits<Function>::arg4_type t4,
-            typename member_function_traits<Function>::arg5_type t5,
-            typename member_function_traits<Function>::arg6_type t6,
-            typename member_function_traits<Function>::arg7_type t7,
-            typename member_function_traits<Function>::arg8_type t8,
-            typename member_function_traits<Function>::arg9_type t9,
-            typename member_function_traits<Function>::arg10_type t10)
+        // replace the content with a value type constructed from 'args'
+        template<typename ValueType, typename... Args>
+        void emplace(Args&&... args)
         {
-            return (content->*fn)(t1, t2, t3, t4, t5, t6, t7, t8, t9, t10);
+            shared_any(in_place_type_t<ValueType>(), std::forward<Args>(args)...).swap(*this);
         }
 
     public: // queries
 
         bool empty() const
         {
-            return !content;
+            return !content.held;
+        }
+
+        // the number of shared_anys sharing the holder (0 if empty)
+        long use_count() const
+        {
+            return content.held ? content.held->use_count() : 0;
         }
 
     public: // comparisons
         // equality
-        friend bool operator==(const any& lhs, const any& rhs)
+        friend bool operator==(const shared_any& lhs, const shared_any& rhs)
         {
-            return lhs.content->equals(*rhs.content);
+            return lhs.content->equals(*rhs.content.get());
         }
-        friend bool operator!=(const any& lhs, const any& rhs) {return !static_cast<bool>(lhs == rhs);}
+        friend bool operator!=(const shared_any& lhs, const shared_any& rhs) {return !static_cast<bool>(lhs == rhs);}
 
         // less than comparable
-        friend bool operator<(const any& lhs, const any& rhs)
+        friend bool operator<(const shared_any& lhs, const shared_any& rhs)
         {
-            return lhs.content->less(*rhs.content);
+            return lhs.content->less(*rhs.content.get());
+        }
+        friend bool operator>(const shared_any& lhs, const shared_any& rhs)  { return rhs < lhs; }
+        friend bool operator<=(const shared_any& lhs, const shared_any& rhs) { return !static_cast<bool>(rhs < lhs); }
+        friend bool operator>=(const shared_any& lhs, const shared_any& rhs) { return !static_cast<bool>(lhs < rhs); }
+
+#ifdef ANY_FACADE_HAS_THREE_WAY_COMPARISON
+        // three way comparable
+        friend std::weak_ordering operator<=>(const shared_any& lhs, const shared_any& rhs)
+        {
+            return lhs.content.get()->compare_to(*rhs.content.get()) <=> 0;
+        }
+#endif
+
+#if __cplusplus > 199711L
+        // hashable (used by std::hash)
+        friend std::size_t hash_value(const shared_any& a)
+        {
+            return a.content.get()->hash();
+        }
+#endif
+
+    private: // representation
+
+        shared_content content;
+    };
+#endif
+
+    //
+    // A non-owning reference to a value type, or to the content of an any,
+    // that forwards calls to the interface; nothing is copied or allocated.
+    // The referenced object must outlive the any_ref.
+    //
+    template <typename Interface = interfaces<>, typename Comparable = not_comparable>
+    class any_ref : public call_forwarding<any_ref<Interface,Comparable> >
+    {
+        // CRTP base classes have access to 'content'
+        friend class forwarder<any_ref>;
+        friend class call_forwarding<any_ref>;
+#if __cplusplus > 199711L
+        friend class forwarding<any_ref>;
+#endif
+        // and so does the holder management
+        friend struct content_management;
+    public:
+        typedef any_ref AnyType;
+        typedef Interface InterfaceType;
+    private:
+        class placeholder : public Comparable::template compare<Interface, placeholder>
+        {
+        public: // queries
+            // set by the holder, so reading it isn't a virtual call
+            type_info<any_ref> type() const { return m_type; }
+            // told when the holder's value is in place, e.g. to cache a key
+            void constructed() {}
+            virtual placeholder* clone(void* buffer) const = 0;
+
+        protected: // representation
+            type_info<any_ref> m_type;
+        };
+    public:
+        //
+        // Refers to the value type; the same value_type_operations as any
+        // provide the interface implementation
+        //
+        template<typename T>
+        class holder ANY_FACADE_FINAL : public value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T>
+        {
+            // CRTP base class has access to 'held'
+            friend class value_type_operations<holder<T>, typename Comparable::template compare2<holder<T>,placeholder>, T>;
+        public: // structors
+            typedef any_ref AnyType;
+            typedef T ValueType;
+
+            explicit holder(ValueType & v)
+                : held(v)
+            {
+                this->m_type = type_info<any_ref>::template type_id<ValueType>();
+                this->constructed();
+            }
+
+        public: // queries
+
+            const ValueType& value() const { return held; }
+
+            virtual placeholder* clone(void* buffer) const
+            {
+                return new (buffer) holder(held);
+            }
+
+        private: // intentionally left unimplemented
+            holder & operator=(const holder &);
+
+        private: // representation
+
+            ValueType& held;
+        };
+
+    public: // structors
+
+        any_ref()
+            : content(0)
+        {
+        }
+
+        template<typename ValueType>
+        any_ref(ValueType & value)
+            : content(0)
+        {
+#if __cplusplus > 199711L
+            static_assert(sizeof(holder<ValueType>) <= sizeof(buffer_type), "holder doesn't fit in any_ref");
+#else
+            (void)sizeof(static_check<sizeof(holder<ValueType>) <= sizeof(buffer_type)>);
+#endif
+            content = new (&m_buffer) holder<ValueType>(value);
+        }
+
+        // refer to the content of 'other' (which must not be changed meanwhile)
+        template<typename OtherComparable, typename Storage>
+        any_ref(any<Interface, OtherComparable, Storage> & other)
+            : content(other.content)
+        {
+        }
+
+#if __cplusplus > 199711L
+        template<typename OtherComparable, typename Storage>
+        any_ref(unique_any<Interface, OtherComparable, Storage> & other)
+            : content(other.content)
+        {
+        }
+#endif
+
+        any_ref(const any_ref & other)
+            : content(0)
+        {
+            content_management::assign(*this, other);
+        }
+
+        // otherwise a non-const any_ref would bind as a value type
+        any_ref(any_ref & other)
+            : content(0)
+        {
+            content_management::assign(*this, other);
+        }
+
+        ~any_ref()
+        {
+            content_management::reset(*this);
+        }
+
+    public: // modifiers
+
+        any_ref & operator=(const any_ref & rhs)
+        {
+            if( this != &rhs )
+            {
+                content_management::reset(*this);
+                content_management::assign(*this, rhs);
+            }
+            return *this;
+        }
+
+    public: // queries
+
+        bool empty() const
+        {
+            return !content;
         }
-        friend bool operator>(const any& lhs, const any& rhs)  { return rhs < lhs; }
-        friend bool operator<=(const any& lhs, const any& rhs) { return !static_cast<bool>(rhs < lhs); }
-        friend bool operator>=(const any& lhs, const any& rhs) { return !static_cast<bool>(lhs < rhs); }
 
     private: // types
 
+        // every holder is the placeholder plus a reference
+        union buffer_type
+        {
+            char data[sizeof(placeholder) + sizeof(void*)];
+            void* p;
+        };
+
     private: // representation
 
-        placeholder* content;
+        Interface* content;
+        buffer_type m_buffer;
     };
 
+#if __cplusplus > 199711L
+    //
+    // Comparators for ordered containers of anys that can also look up raw
+    // values, e.g. std::map<Key, V, transparent_less>::find(42) doesn't have to
+    // make an any (or allocate) to find the entry...
+    //
+    struct transparent_less
+    {
+        typedef void is_transparent;
+        template <typename L, typename R>
+        bool operator()(const L& lhs, const R& rhs) const
+        {
+            return lhs < rhs;
+        }
+    };
+    struct transparent_equal_to
+    {
+        typedef void is_transparent;
+        template <typename L, typename R>
+        bool operator()(const L& lhs, const R& rhs) const
+        {
+            return lhs == rhs;
+        }
+    };
+#endif
+}
+
+#if __cplusplus > 199711L
+namespace std
+{
+    // anys with a hashable comparability can be keys of unordered containers
+    template <typename Interface, typename Comparable, typename Storage>
+    struct hash<any_facade::any<Interface, Comparable, Storage> >
+    {
+        std::size_t operator()(const any_facade::any<Interface, Comparable, Storage>& a) const
+        {
+            return hash_value(a);
+        }
+    };
+
+    template <typename Interface, typename Comparable, typename Storage>
+    struct hash<any_facade::unique_any<Interface, Comparable, Storage> >
+    {
+        std::size_t operator()(const any_facade::unique_any<Interface, Comparable, Storage>& a) const
+        {
+            return hash_value(a);
+        }
+    };
+
+    template <typename Interface, typename Comparable>
+    struct hash<any_facade::shared_any<Interface, Comparable> >
+    {
+        std::size_t operator()(const any_facade::shared_any<Interface, Comparable>& a) const
+        {
+            return hash_value(a);
+        }
+    };
 }
+#endif
 
 #endif // ANY_FACADE_HPP_INCLUDED
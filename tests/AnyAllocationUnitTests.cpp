@@ -0,0 +1,186 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#if __cplusplus > 199711L
+
+#include <atomic>
+
+namespace
+{
+    // counts every allocation made by the test program
+    std::atomic<long> allocations(0);
+}
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    void* p = std::malloc(size ? size : 1);
+    if( !p )
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    ++allocations;
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+#endif
+
+namespace af = any_facade;
+
+namespace
+{
+    struct Named
+    {
+        virtual ~Named() {}
+        virtual std::size_t length() const = 0;
+    };
+
+    typedef af::any<af::interfaces<Named> > Key;
+    typedef af::any<af::interfaces<Named>, af::type_ordered<af::less_than_equals_comparable> > OrderedKey;
+}
+
+namespace any_facade
+{
+    template <>
+    class forwarder<Key>
+    {
+    public:
+        std::size_t length() const
+        {
+            return static_cast<const Key*>(this)->content->length();
+        }
+    };
+
+    template <>
+    class forwarder<OrderedKey>
+    {
+    public:
+        std::size_t length() const
+        {
+            return static_cast<const OrderedKey*>(this)->content->length();
+        }
+    };
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual std::size_t length() const
+        {
+            return static_cast<const Derived*>(this)->held.size();
+        }
+    };
+}
+
+namespace AnyAllocationUnitTests
+{
+    TEST_CASE("Require comparisons don't copy the held values", "[allocation]")
+    {
+        // long enough not to fit in the small string buffer
+        const Key a(std::string(100, 'a'));
+        const Key b(std::string(100, 'b'));
+
+        const long before = allocations;
+        const bool less = (a < b);
+        const bool equal = (a == b);
+        REQUIRE(allocations == before);
+        REQUIRE(less);
+        REQUIRE(!equal);
+    }
+
+    TEST_CASE("Require map find doesn't allocate", "[allocation]")
+    {
+        std::map<Key, int> keys;
+        for( int i = 0; i < 100; ++i )
+        {
+            keys.insert(std::make_pair(Key(std::string(100, 'a') + std::to_string(i)), i));
+        }
+        const Key key(std::string(100, 'a') + "42");
+
+        const long before = allocations;
+        std::map<Key, int>::const_iterator found = keys.find(key);
+        REQUIRE(allocations == before);
+        REQUIRE(found != keys.end());
+        REQUIRE(found->second == 42);
+    }
+
+#if __cplusplus >= 201402L
+    TEST_CASE("Require map find with a raw value doesn't allocate if ordered by type", "[allocation]")
+    {
+        std::map<OrderedKey, int, af::transparent_less> keys;
+        for( int i = 0; i < 100; ++i )
+        {
+            keys.insert(std::make_pair(OrderedKey(std::string(100, 'a') + std::to_string(i)), i));
+        }
+        const std::string key(std::string(100, 'a') + "42");
+
+        const long before = allocations;
+        std::map<OrderedKey, int, af::transparent_less>::const_iterator found = keys.find(key);
+        const bool missing = (keys.find(std::string("b")) == keys.end());
+        REQUIRE(allocations == before);
+        REQUIRE(found != keys.end());
+        REQUIRE(found->second == 42);
+        REQUIRE(missing);
+    }
+
+    TEST_CASE("Require map find with a raw value finds it otherwise", "[allocation]")
+    {
+        std::map<Key, int, af::transparent_less> keys;
+        for( int i = 0; i < 100; ++i )
+        {
+            keys.insert(std::make_pair(Key(std::string(100, 'a') + std::to_string(i)), i));
+        }
+        keys.insert(std::make_pair(Key(std::vector<int>(3)), -1));
+
+        // values are copied into a holder, as equals and less may be overridden
+        REQUIRE(keys.find(std::string(100, 'a') + "42")->second == 42);
+        REQUIRE(keys.find(std::string("b")) == keys.end());
+        REQUIRE(keys.find(std::vector<int>(3))->second == -1);
+        REQUIRE(keys.find(std::vector<int>(4)) == keys.end());
+    }
+
+    TEST_CASE("Require map find with a raw value of another type doesn't allocate if ordered by type", "[allocation]")
+    {
+        std::map<OrderedKey, int, af::transparent_less> keys;
+        for( int i = 0; i < 10; ++i )
+        {
+            keys.insert(std::make_pair(OrderedKey(std::string(100, 'a') + std::to_string(i)), i));
+        }
+        keys.insert(std::make_pair(OrderedKey(std::vector<int>(3)), -1));
+        const std::vector<int> key(3);
+        const std::vector<int> other(4);
+
+        const long before = allocations;
+        std::map<OrderedKey, int, af::transparent_less>::const_iterator found = keys.find(key);
+        const bool missing = (keys.find(other) == keys.end());
+        const bool equal = (keys.begin()->first == other);
+        REQUIRE(allocations == before);
+        REQUIRE(found != keys.end());
+        REQUIRE(found->second == -1);
+        REQUIRE(missing);
+        REQUIRE(!equal);
+    }
+#endif
+}
+
+#endif
@@ -0,0 +1,265 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <utility>
+#include <vector>
+
+#if __cplusplus > 199711L
+
+namespace af = any_facade;
+
+namespace
+{
+    struct AllocatorInterface
+    {
+        virtual ~AllocatorInterface() {}
+        virtual int get() const = 0;
+    };
+
+    // counts what's outstanding in each 'arena'
+    struct Arena
+    {
+        Arena() : allocations(0), outstanding(0) {}
+        int allocations;
+        int outstanding;
+    };
+
+    template <typename T>
+    struct ArenaAllocator
+    {
+        typedef T value_type;
+
+        explicit ArenaAllocator(Arena& a) : arena(&a) {}
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+        T* allocate(std::size_t n)
+        {
+            ++arena->allocations;
+            ++arena->outstanding;
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        void deallocate(T* p, std::size_t)
+        {
+            --arena->outstanding;
+            ::operator delete(p);
+        }
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+        Arena* arena;
+    };
+
+    typedef af::allocator_storage<ArenaAllocator<char> > ArenaStorage;
+    typedef af::any<AllocatorInterface, af::less_than_equals_comparable, ArenaStorage> ArenaAny;
+    typedef af::any<AllocatorInterface, af::less_than_equals_comparable, af::allocator_storage<> > StdAllocatorAny;
+#ifdef ANY_FACADE_HAS_MEMORY_RESOURCE
+    typedef af::any<AllocatorInterface, af::less_than_equals_comparable, af::pmr_storage> PmrAny;
+#endif
+}
+
+namespace any_facade
+{
+    template <>
+    class forwarder<ArenaAny>
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const ArenaAny*>(this)->content->get();
+        }
+    };
+    template <>
+    class forwarder<StdAllocatorAny>
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const StdAllocatorAny*>(this)->content->get();
+        }
+    };
+#ifdef ANY_FACADE_HAS_MEMORY_RESOURCE
+    template <>
+    class forwarder<PmrAny>
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const PmrAny*>(this)->content->get();
+        }
+    };
+#endif
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual int get() const
+        {
+            return static_cast<const Derived*>(this)->held;
+        }
+    };
+}
+
+namespace AnyAllocatorUnitTests
+{
+    TEST_CASE("Require values are allocated from the allocator", "[allocator]")
+    {
+        Arena arena;
+        {
+            ArenaAny a(42, ArenaStorage(ArenaAllocator<char>(arena)));
+            REQUIRE(a.get() == 42);
+            REQUIRE(arena.allocations == 1);
+            REQUIRE(arena.outstanding == 1);
+        }
+        REQUIRE(arena.outstanding == 0);
+    }
+
+    TEST_CASE("Require copies and emplace use the same allocator", "[allocator]")
+    {
+        Arena arena;
+        {
+            ArenaAny a(42, ArenaStorage(ArenaAllocator<char>(arena)));
+            ArenaAny b(a);
+            REQUIRE(b.get() == 42);
+            REQUIRE(arena.outstanding == 2);
+
+            ArenaStorage storage((ArenaAllocator<char>(arena)));
+            ArenaAny c(storage);
+            REQUIRE(c.empty());
+            c.emplace<int>(666);
+            REQUIRE(c.get() == 666);
+            REQUIRE(arena.outstanding == 3);
+
+            std::vector<ArenaAny> v(3, a);
+            REQUIRE(arena.outstanding == 6);
+        }
+        REQUIRE(arena.outstanding == 0);
+    }
+
+    TEST_CASE("Require move within an allocator doesn't allocate", "[allocator]")
+    {
+        Arena arena;
+        {
+            ArenaAny a(42, ArenaStorage(ArenaAllocator<char>(arena)));
+            ArenaAny b(std::move(a));
+            ArenaStorage storage((ArenaAllocator<char>(arena)));
+            ArenaAny c(storage);
+            c = std::move(b);
+            REQUIRE(c.get() == 42);
+            REQUIRE(arena.allocations == 1);
+        }
+        REQUIRE(arena.outstanding == 0);
+    }
+
+    TEST_CASE("Require assignment keeps the target's allocator", "[allocator]")
+    {
+        Arena arena1;
+        Arena arena2;
+        {
+            ArenaAny a(42, ArenaStorage(ArenaAllocator<char>(arena1)));
+            ArenaAny b(666, ArenaStorage(ArenaAllocator<char>(arena2)));
+            b = a;
+            REQUIRE(b.get() == 42);
+            REQUIRE(arena1.outstanding == 1);
+            REQUIRE(arena2.outstanding == 1);
+
+            ArenaAny c(7, ArenaStorage(ArenaAllocator<char>(arena1)));
+            b = std::move(c);
+            REQUIRE(b.get() == 7);
+            REQUIRE(c.empty());
+            REQUIRE(arena1.outstanding == 1);
+            REQUIRE(arena2.outstanding == 1);
+
+            a.swap(b);
+            REQUIRE(a.get() == 7);
+            REQUIRE(b.get() == 42);
+            REQUIRE(arena1.outstanding == 1);
+            REQUIRE(arena2.outstanding == 1);
+        }
+        REQUIRE(arena1.outstanding == 0);
+        REQUIRE(arena2.outstanding == 0);
+    }
+
+    TEST_CASE("Require move assignment only throws if allocators can differ", "[allocator]")
+    {
+        REQUIRE(std::is_nothrow_move_assignable<StdAllocatorAny>::value);
+        REQUIRE(std::is_nothrow_move_constructible<ArenaAny>::value);
+        REQUIRE(!std::is_nothrow_move_assignable<ArenaAny>::value);
+    }
+
+    TEST_CASE("Require swap only throws if allocators can differ", "[allocator]")
+    {
+        REQUIRE(noexcept(std::declval<StdAllocatorAny&>().swap(std::declval<StdAllocatorAny&>())));
+        REQUIRE(!noexcept(std::declval<ArenaAny&>().swap(std::declval<ArenaAny&>())));
+    }
+
+#ifdef ANY_FACADE_HAS_MEMORY_RESOURCE
+    TEST_CASE("Require failed move assignment leaves both anys unchanged", "[allocator]")
+    {
+        // room for one holder only
+        alignas(std::max_align_t) char buffer[sizeof(PmrAny::holder<int>)];
+        std::pmr::monotonic_buffer_resource full(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        PmrAny a(42, af::pmr_storage(&full));
+        PmrAny b(666, af::pmr_storage(std::pmr::new_delete_resource()));
+        REQUIRE_THROWS_AS(a = std::move(b), std::bad_alloc);
+        REQUIRE(a.get() == 42);
+        REQUIRE(b.get() == 666);
+    }
+
+    TEST_CASE("Require swap between different memory resources swaps the values", "[allocator]")
+    {
+        char buffer1[256];
+        char buffer2[256];
+        std::pmr::monotonic_buffer_resource arena1(buffer1, sizeof(buffer1), std::pmr::null_memory_resource());
+        std::pmr::monotonic_buffer_resource arena2(buffer2, sizeof(buffer2), std::pmr::null_memory_resource());
+        const af::pmr_storage storage2(&arena2);
+        PmrAny a(42, af::pmr_storage(&arena1));
+        PmrAny b(storage2);
+
+        a.swap(b);
+        REQUIRE(a.empty());
+        REQUIRE(b.get() == 42);
+        a.emplace<int>(666);
+        a.swap(b);
+        REQUIRE(a.get() == 42);
+        REQUIRE(b.get() == 666);
+    }
+
+    TEST_CASE("Require failed swap leaves both anys unchanged", "[allocator]")
+    {
+        // room for one holder only
+        alignas(std::max_align_t) char buffer[sizeof(PmrAny::holder<int>)];
+        std::pmr::monotonic_buffer_resource full(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        PmrAny a(42, af::pmr_storage(&full));
+        PmrAny b(666, af::pmr_storage(std::pmr::new_delete_resource()));
+
+        REQUIRE_THROWS_AS(a.swap(b), std::bad_alloc);
+        REQUIRE(a.get() == 42);
+        REQUIRE(b.get() == 666);
+
+        REQUIRE_THROWS_AS(b.swap(a), std::bad_alloc);
+        REQUIRE(a.get() == 42);
+        REQUIRE(b.get() == 666);
+    }
+
+    TEST_CASE("Require values can live in a monotonic memory resource", "[allocator]")
+    {
+        char buffer[1024];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        af::pmr_storage storage(&arena);
+        PmrAny a(42, storage);
+        PmrAny b(a);
+        PmrAny c(storage);
+        c.emplace<int>(666);
+        REQUIRE(a.get() == 42);
+        REQUIRE(b.get() == 42);
+        REQUIRE(c.get() == 666);
+        REQUIRE(a == b);
+        REQUIRE(a != c);
+    }
+#endif
+}
+
+#endif
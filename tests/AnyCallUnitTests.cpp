@@ -5,11 +5,23 @@ namespace af = any_facade;
 
 namespace
 {
+    struct Counted
+    {
+        Counted(int v) : value(v) {}
+        Counted(const Counted& other) : value(other.value) { ++copies; }
+        int value;
+        static int copies;
+    };
+    int Counted::copies = 0;
+
     struct TestCallInterface
     {
         virtual ~TestCallInterface() {}
         virtual int f0() const = 0;
         virtual int f1(int) const = 0;
+        virtual int f11(int, int, int, int, int, int, int, int, int, int, int) const = 0;
+        virtual void set(int) = 0;
+        virtual int sink(Counted) const = 0;
     };
 }
 
@@ -32,6 +44,12 @@ namespace any_facade
     public:
         virtual int f0() const { return static_cast<const Derived*>(this)->held;}
         virtual int f1(int t1) const {return static_cast<const Derived*>(this)->held + t1;}
+        virtual int f11(int t1, int t2, int t3, int t4, int t5, int t6, int t7, int t8, int t9, int t10, int t11) const
+        {
+            return static_cast<const Derived*>(this)->held + t1 + t2 + t3 + t4 + t5 + t6 + t7 + t8 + t9 + t10 + t11;
+        }
+        virtual void set(int t1) { static_cast<Derived*>(this)->held = t1; }
+        virtual int sink(Counted c) const { return c.value; }
     };
 }
 
@@ -48,4 +66,54 @@ namespace AnyCallUnitTests
         af::any<af::interfaces<TestCallInterface> > a(1);
         REQUIRE(a.call(&TestCallInterface::f1, 2) == 3);
     }
+
+#if __cplusplus > 199711L
+    TEST_CASE("Require call more than ten params", "[call]")
+    {
+        af::any<af::interfaces<TestCallInterface> > a(1);
+        REQUIRE(a.call(&TestCallInterface::f11, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1) == 12);
+    }
+
+    TEST_CASE("Require call on a const any calls a const function", "[call]")
+    {
+        const af::any<af::interfaces<TestCallInterface> > a(1);
+        REQUIRE(a.call(&TestCallInterface::f1, 2) == 3);
+    }
+
+    TEST_CASE("Require call on an rvalue any", "[call]")
+    {
+        typedef af::any<af::interfaces<TestCallInterface> > Any;
+        REQUIRE(Any(1).call(&TestCallInterface::f0) == 1);
+    }
+
+    TEST_CASE("Require call a non-const function", "[call]")
+    {
+        af::any<af::interfaces<TestCallInterface> > a(1);
+        a.call(&TestCallInterface::set, 5);
+        REQUIRE(a.call(&TestCallInterface::f0) == 5);
+    }
+
+    TEST_CASE("Require call copies a by value argument once", "[call]")
+    {
+        af::any<af::interfaces<TestCallInterface> > a(1);
+        Counted c(4);
+        Counted::copies = 0;
+        REQUIRE(a.call(&TestCallInterface::sink, c) == 4);
+        REQUIRE(Counted::copies == 1);
+    }
+#endif
+
+#if __cplusplus >= 201703L
+    TEST_CASE("Require call with the function as a template argument", "[call]")
+    {
+        af::any<af::interfaces<TestCallInterface> > a(1);
+        REQUIRE(a.call<&TestCallInterface::f0>() == 1);
+        REQUIRE(a.call<&TestCallInterface::f1>(2) == 3);
+        a.call<&TestCallInterface::set>(5);
+        REQUIRE(a.call<&TestCallInterface::f0>() == 5);
+
+        const af::any<af::interfaces<TestCallInterface> >& c = a;
+        REQUIRE(c.call<&TestCallInterface::f1>(2) == 7);
+    }
+#endif
 }
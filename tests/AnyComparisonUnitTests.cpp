@@ -1,6 +1,8 @@
 #include "catch.hpp"
 #include "any_facade.hpp"
+#include <cctype>
 #include <map>
+#include <string>
 #include <vector>
 #include <typeinfo>
 
@@ -34,6 +36,14 @@ namespace
         int value;
     };
 
+    struct ThreeWayComparableType
+    {
+        ThreeWayComparableType(int v) : value(v) {}
+        int value;
+        static int comparisons;
+    };
+    int ThreeWayComparableType::comparisons = 0;
+
     struct DefaultComparableType
     {
         DefaultComparableType(int v) : value(v) {}
@@ -47,6 +57,15 @@ namespace
             return (lhs.value < rhs.value);
         }
     };
+
+    // equal ignoring case when held by an any (see value_type_operations below)
+    struct Name
+    {
+        Name(const std::string& s) : s(s) {}
+        std::string s;
+        friend bool operator==(const Name& lhs, const Name& rhs) { return lhs.s == rhs.s; }
+        friend bool operator<(const Name& lhs, const Name& rhs) { return lhs.s < rhs.s; }
+    };
 }
 
 namespace any_facade
@@ -76,6 +95,13 @@ namespace any_facade
         return (lhs.value == rhs.value);
     }
 
+    template<>
+    int three_way_comparable::three_way<ThreeWayComparableType>(const ThreeWayComparableType& lhs, const ThreeWayComparableType& rhs)
+    {
+        ++ThreeWayComparableType::comparisons;
+        return lhs.value - rhs.value;
+    }
+
     //
     // forwarder<any<...> > doesn't *need* any methods defined....
     // (unless you want to use them...)
@@ -104,6 +130,12 @@ namespace any_facade
     public:
         // no methods
     };
+    template <>
+    class forwarder<any<TestInterface1, three_way_comparable> >
+    {
+    public:
+        // no methods
+    };
 
     // implementation of value_type_operations does nothing
     template <typename Derived, typename Base, typename ValueType>
@@ -111,6 +143,25 @@ namespace any_facade
     {
     public:
     };
+
+    template <typename Derived, typename Base>
+    class value_type_operations<Derived, Base, Name> : public Base
+    {
+    public:
+        typedef typename Base::PlaceholderType PlaceholderType;
+        virtual bool equals(const PlaceholderType& other) const
+        {
+            if( static_cast<const Derived*>(this)->type() != other.type() ) return false;
+            const std::string& lhs = static_cast<const Derived*>(this)->value().s;
+            const std::string& rhs = static_cast<const Derived*>(&other)->value().s;
+            if( lhs.size() != rhs.size() ) return false;
+            for( std::size_t i = 0; i < lhs.size(); ++i )
+            {
+                if( std::tolower(lhs[i]) != std::tolower(rhs[i]) ) return false;
+            }
+            return true;
+        }
+    };
 }
 
 namespace AnyComparisonUnitTests
@@ -195,4 +246,103 @@ namespace AnyComparisonUnitTests
         REQUIRE(a != b);
         REQUIRE(c == b);
     }
+
+    TEST_CASE("Object with three way specialization compares with one comparison","")
+    {
+        typedef TestInterface1 Interface;
+        typedef af::three_way_comparable Comparable;
+        typedef af::any<Interface, Comparable> Any;
+
+        Any a(ThreeWayComparableType(4));
+        Any b(ThreeWayComparableType(7));
+        Any c(ThreeWayComparableType(7));
+        Any d(DefaultComparableType(7));
+
+        ThreeWayComparableType::comparisons = 0;
+        REQUIRE(a < b);
+        REQUIRE(a != b);
+        REQUIRE(c == b);
+        REQUIRE(b <= c);
+        REQUIRE(ThreeWayComparableType::comparisons == 4);
+
+        // different types are ordered by type, and never equal
+        REQUIRE(b != d);
+        REQUIRE(((b < d) != (d < b)));
+#ifdef ANY_FACADE_HAS_THREE_WAY_COMPARISON
+        REQUIRE(std::is_lt(a <=> b));
+        REQUIRE(std::is_eq(c <=> b));
+        REQUIRE(std::is_gt(b <=> a));
+#endif
+    }
+
+#if __cplusplus > 199711L
+    TEST_CASE("Object compares with raw values like with anys","")
+    {
+        typedef TestInterface1 Interface;
+        typedef af::less_than_equals_comparable Comparable;
+        typedef af::any<Interface, Comparable> Any;
+
+        Any a(DefaultComparableType(4));
+        Any b(FullyComparableType(7));
+
+        REQUIRE(a == DefaultComparableType(4));
+        REQUIRE(DefaultComparableType(4) == a);
+        REQUIRE(a != DefaultComparableType(5));
+        REQUIRE(a < DefaultComparableType(5));
+        REQUIRE(DefaultComparableType(3) < a);
+        REQUIRE(a >= DefaultComparableType(4));
+        REQUIRE(b == FullyComparableType(7));
+        REQUIRE(b > FullyComparableType(6));
+
+        // different types are ordered by type, and never equal
+        REQUIRE(a != FullyComparableType(4));
+        REQUIRE((a < FullyComparableType(4)) == (a < Any(FullyComparableType(4))));
+        REQUIRE((FullyComparableType(4) < a) == (Any(FullyComparableType(4)) < a));
+    }
+
+    TEST_CASE("Object with three way specialization compares with raw values","")
+    {
+        typedef TestInterface1 Interface;
+        typedef af::three_way_comparable Comparable;
+        typedef af::any<Interface, Comparable> Any;
+
+        Any a(ThreeWayComparableType(4));
+
+        ThreeWayComparableType::comparisons = 0;
+        REQUIRE(a < ThreeWayComparableType(7));
+        REQUIRE(a == ThreeWayComparableType(4));
+        REQUIRE(ThreeWayComparableType::comparisons == 2);
+    }
+
+    TEST_CASE("Object compares with raw values through overridden equals","")
+    {
+        typedef TestInterface1 Interface;
+        typedef af::less_than_equals_comparable Comparable;
+        typedef af::any<Interface, Comparable> Any;
+
+        Any a(Name("abc"));
+
+        REQUIRE(a == Any(Name("ABC")));
+        REQUIRE(a == Name("ABC"));
+        REQUIRE(Name("ABC") == a);
+        REQUIRE(a != Name("abd"));
+    }
+
+    TEST_CASE("Object compares with string literals like with anys","")
+    {
+        typedef TestInterface1 Interface;
+        typedef af::less_than_equals_comparable Comparable;
+        typedef af::any<Interface, Comparable> Any;
+
+        Any a(std::string("x"));
+        const char* x = "x";
+        Any b(x);
+
+        // a literal is held as a const char*, like when making an any from it
+        REQUIRE(a != "x");
+        REQUIRE((a < "x") == (a < Any("x")));
+        REQUIRE(("x" < a) == (Any("x") < a));
+        REQUIRE(b == x);
+    }
+#endif
 }
@@ -0,0 +1,161 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <map>
+
+#if __cplusplus > 199711L
+
+namespace af = any_facade;
+
+namespace
+{
+    struct Length
+    {
+        virtual ~Length() {}
+        virtual double millimetres() const = 0;
+    };
+
+    struct Metres
+    {
+        explicit Metres(double v) : value(v) {}
+        double value;
+        friend bool operator==(const Metres& lhs, const Metres& rhs) { return lhs.value == rhs.value; }
+        friend bool operator<(const Metres& lhs, const Metres& rhs) { return lhs.value < rhs.value; }
+    };
+
+    struct Millimetres
+    {
+        explicit Millimetres(int v) : value(v) {}
+        int value;
+        friend bool operator==(const Millimetres& lhs, const Millimetres& rhs) { return lhs.value == rhs.value; }
+        friend bool operator<(const Millimetres& lhs, const Millimetres& rhs) { return lhs.value < rhs.value; }
+    };
+
+    struct Unregistered
+    {
+        explicit Unregistered(int v) : value(v) {}
+        int value;
+        friend bool operator==(const Unregistered& lhs, const Unregistered& rhs) { return lhs.value == rhs.value; }
+        friend bool operator<(const Unregistered& lhs, const Unregistered& rhs) { return lhs.value < rhs.value; }
+    };
+
+    typedef af::any<Length, af::cross_type_comparable<af::less_than_equals_comparable> > Any;
+    typedef af::any<Length, af::type_ordered<af::cross_type_comparable<af::less_than_equals_comparable> > > OrderedAny;
+
+    bool equals(const Metres& lhs, const Millimetres& rhs) { return lhs.value * 1000 == rhs.value; }
+    bool equals(const Millimetres& lhs, const Metres& rhs) { return equals(rhs, lhs); }
+    bool less(const Metres& lhs, const Millimetres& rhs) { return lhs.value * 1000 < rhs.value; }
+    bool less(const Millimetres& lhs, const Metres& rhs) { return lhs.value < rhs.value * 1000; }
+
+    struct Registration
+    {
+        Registration()
+        {
+            af::binary_dispatch<Any, af::equality_comparable>::add<Metres, Millimetres, &equals>();
+            af::binary_dispatch<Any, af::equality_comparable>::add<Millimetres, Metres, &equals>();
+            af::binary_dispatch<Any, af::less_than_comparable>::add<Metres, Millimetres, &less>();
+            af::binary_dispatch<Any, af::less_than_comparable>::add<Millimetres, Metres, &less>();
+            af::binary_dispatch<OrderedAny, af::equality_comparable>::add<Metres, Millimetres, &equals>();
+            af::binary_dispatch<OrderedAny, af::less_than_comparable>::add<Metres, Millimetres, &less>();
+            af::binary_dispatch<OrderedAny, af::less_than_comparable>::add<Millimetres, Metres, &less>();
+        }
+    } registration;
+}
+
+namespace any_facade
+{
+    template <>
+    class forwarder<Any>
+    {
+    public:
+        double millimetres() const
+        {
+            return static_cast<const Any*>(this)->content->millimetres();
+        }
+    };
+
+    template <>
+    class forwarder<OrderedAny>
+    {
+    public:
+        double millimetres() const
+        {
+            return static_cast<const OrderedAny*>(this)->content->millimetres();
+        }
+    };
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual double millimetres() const { return 0; }
+    };
+}
+
+namespace AnyDispatchUnitTests
+{
+    TEST_CASE("Require registered cross type equality is used", "[dispatch]")
+    {
+        REQUIRE(Any(Metres(1.5)) == Any(Millimetres(1500)));
+        REQUIRE(Any(Millimetres(1500)) == Any(Metres(1.5)));
+        REQUIRE(Any(Metres(1.5)) != Any(Millimetres(1501)));
+    }
+
+    TEST_CASE("Require registered cross type ordering is used", "[dispatch]")
+    {
+        REQUIRE(Any(Metres(1)) < Any(Millimetres(1001)));
+        REQUIRE(!(Any(Millimetres(1001)) < Any(Metres(1))));
+        REQUIRE(Any(Millimetres(999)) < Any(Metres(1)));
+
+        std::map<Any, int> lengths;
+        lengths[Any(Metres(2))] = 2;
+        lengths[Any(Millimetres(1000))] = 1;
+        lengths[Any(Millimetres(3000))] = 3;
+        REQUIRE(lengths.find(Any(Millimetres(2000))) != lengths.end());
+        REQUIRE(lengths.find(Any(Millimetres(2000)))->second == 2);
+        REQUIRE(lengths.begin()->second == 1);
+    }
+
+    TEST_CASE("Require unregistered pairs compare by type", "[dispatch]")
+    {
+        Any metres(Metres(1));
+        Any other(Unregistered(1000));
+        REQUIRE(metres != other);
+        REQUIRE(((metres < other) != (other < metres)));
+        REQUIRE(Any(Unregistered(1)) == Any(Unregistered(1)));
+    }
+
+    TEST_CASE("Require registered cross type functions are used with raw values", "[dispatch]")
+    {
+        const OrderedAny metres(Metres(1));
+        REQUIRE(metres == Millimetres(1000));
+        REQUIRE(metres < Millimetres(1001));
+        REQUIRE(!(metres < Millimetres(999)));
+        REQUIRE(Millimetres(999) < metres);
+        REQUIRE(!(Millimetres(1001) < metres));
+
+        // equality is registered one way round, and works both ways
+        const OrderedAny millimetres(Millimetres(1000));
+        REQUIRE(millimetres == Metres(1));
+        REQUIRE(Metres(1) == millimetres);
+        REQUIRE(millimetres == OrderedAny(Metres(1)));
+        REQUIRE(millimetres != Metres(2));
+
+        // unregistered pairs are ordered by type, and never equal
+        REQUIRE(millimetres != Unregistered(1000));
+        REQUIRE((millimetres < Unregistered(1)) == (millimetres < OrderedAny(Unregistered(1))));
+        REQUIRE((Unregistered(1) < millimetres) == (OrderedAny(Unregistered(1)) < millimetres));
+    }
+
+    TEST_CASE("Require dispatch table is dense by ordinal", "[dispatch]")
+    {
+        typedef af::binary_dispatch<Any, af::equality_comparable> Table;
+        const std::size_t metres = af::type_ordinals<Any>::of<Metres>();
+        const std::size_t millimetres = af::type_ordinals<Any>::of<Millimetres>();
+        REQUIRE(metres != millimetres);
+        REQUIRE(Table::find(metres, millimetres) != 0);
+        REQUIRE(Table::find(metres, metres) == 0);
+        REQUIRE(Table::find(metres, 1000) == 0);
+    }
+}
+
+#endif
@@ -0,0 +1,180 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <string>
+
+#if __cplusplus > 199711L
+
+namespace af = any_facade;
+
+namespace
+{
+    struct Named
+    {
+        virtual ~Named() {}
+    };
+
+    struct Printable
+    {
+        virtual ~Printable() {}
+        virtual void print(std::ostream& os) const = 0;
+    };
+
+    struct Counter
+    {
+        virtual ~Counter() {}
+        virtual int count() const = 0;
+        virtual void add(int n) = 0;
+    };
+
+    // forwarding functions written on their base, so they can be checked
+    template <typename Base>
+    struct print_functions : public Base
+    {
+        void print(std::ostream& os) const
+        {
+            this->content()->print(os);
+        }
+    };
+
+    template <typename Base>
+    struct no_functions : public Base
+    {
+    };
+
+    template <typename Base>
+    struct non_const_print_functions : public Base
+    {
+        void print(std::ostream& os)
+        {
+            this->content()->print(os);
+        }
+    };
+
+    typedef af::any<Printable> PrintAny;
+    typedef af::any<af::interfaces<Printable, Counter> > CountAny;
+    typedef af::any<af::interfaces<Named, Printable> > NamedAny;
+}
+
+namespace any_facade
+{
+    //
+    // Method implemented... non-virtual so any doesn't get a vptr; checking
+    // the signature ensures that changes to the interface will get caught
+    // by the compiler
+    //
+    template <>
+    class forwarder<PrintAny>
+    {
+    public:
+        void print(std::ostream& os) const
+        {
+            static_cast<const PrintAny*>(this)->content->print(os);
+        }
+        static_assert(same_signature<decltype(&forwarder::print), decltype(&Printable::print)>::value,
+                      "print doesn't match Printable");
+    };
+
+    // As above, for functions on more than one interface
+    template <>
+    class forwarder<CountAny>
+    {
+    public:
+        void print(std::ostream& os) const
+        {
+            static_cast<const CountAny*>(this)->content->print(os);
+        }
+        int count() const
+        {
+            return static_cast<const CountAny*>(this)->content->count();
+        }
+        void add(int n)
+        {
+            static_cast<CountAny*>(this)->content->add(n);
+        }
+        static_assert(same_signature<decltype(&forwarder::print), decltype(&Printable::print)>::value,
+                      "print doesn't match Printable");
+        static_assert(same_signature<decltype(&forwarder::count), decltype(&Counter::count)>::value,
+                      "count doesn't match Counter");
+        static_assert(same_signature<decltype(&forwarder::add), decltype(&Counter::add)>::value,
+                      "add doesn't match Counter");
+    };
+
+    //
+    // Methods implemented on their base... forwards_all checks they cover
+    // all of the interfaces
+    //
+    template <>
+    class forwarder<NamedAny> : public print_functions<forwarding<NamedAny> >
+    {
+    };
+    static_assert(forwards_all<print_functions, interfaces<Named, Printable> >::value,
+                  "print_functions doesn't forward all of Named and Printable");
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual void print(std::ostream& os) const
+        {
+            os << static_cast<const Derived*>(this)->held;
+        }
+        virtual int count() const
+        {
+            return static_cast<int>(static_cast<const Derived*>(this)->held.size());
+        }
+        virtual void add(int n)
+        {
+            static_cast<Derived*>(this)->held.append(n, '+');
+        }
+    };
+}
+
+namespace AnyForwarderUnitTests
+{
+    TEST_CASE("Require same_signature matches member functions of different classes", "[forwarder]")
+    {
+        REQUIRE((af::same_signature<void (Named::*)(std::ostream&) const, void (Printable::*)(std::ostream&) const>::value));
+        REQUIRE(!(af::same_signature<void (Named::*)(std::ostream&), void (Printable::*)(std::ostream&) const>::value));
+        REQUIRE(!(af::same_signature<int (Named::*)() const, long (Counter::*)() const>::value));
+        REQUIRE(!(af::same_signature<void (Named::*)(int), void (Counter::*)(long)>::value));
+    }
+
+    TEST_CASE("Require any with a non-virtual forwarder is just a pointer", "[forwarder]")
+    {
+        REQUIRE(sizeof(PrintAny) == sizeof(void*));
+
+        PrintAny a(std::string("42"));
+        std::ostringstream oss;
+        a.print(oss);
+        REQUIRE(oss.str() == "42");
+    }
+
+    TEST_CASE("Require non-virtual forwarders for more than one interface", "[forwarder]")
+    {
+        REQUIRE(sizeof(CountAny) == sizeof(void*));
+
+        CountAny a(std::string("ab"));
+        REQUIRE(a.count() == 2);
+        a.add(3);
+        REQUIRE(a.count() == 5);
+
+        std::ostringstream oss;
+        a.print(oss);
+        REQUIRE(oss.str() == "ab+++");
+    }
+
+    TEST_CASE("Require forwards_all checks every interface function is forwarded", "[forwarder]")
+    {
+        REQUIRE(af::forwards_all<print_functions, Printable>::value);
+        REQUIRE(!af::forwards_all<no_functions, Printable>::value);
+        REQUIRE(!af::forwards_all<non_const_print_functions, Printable>::value);
+        REQUIRE(sizeof(NamedAny) == sizeof(void*));
+
+        NamedAny a(std::string("42"));
+        std::ostringstream oss;
+        a.print(oss);
+        REQUIRE(oss.str() == "42");
+    }
+}
+
+#endif
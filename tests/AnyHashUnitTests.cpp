@@ -0,0 +1,109 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#if __cplusplus > 199711L
+
+namespace af = any_facade;
+
+namespace
+{
+    struct Describable
+    {
+        virtual ~Describable() {}
+        virtual int id() const = 0;
+    };
+
+    // no std::hash, so hashable::hash is specialized below
+    struct Point
+    {
+        Point(int x, int y) : x(x), y(y) {}
+        int x;
+        int y;
+        static int hashes;
+        friend bool operator==(const Point& lhs, const Point& rhs)
+        {
+            return (lhs.x == rhs.x && lhs.y == rhs.y);
+        }
+    };
+    int Point::hashes = 0;
+
+    typedef af::any<Describable, af::hashable_equality_comparable> Key;
+    typedef af::any<Describable, af::cached_hash<af::hashable_equality_comparable> > CachedKey;
+}
+
+namespace any_facade
+{
+    template <>
+    std::size_t hashable::hash<Point>(const Point& p)
+    {
+        ++Point::hashes;
+        return std::hash<int>()(p.x * 31 + p.y);
+    }
+
+    template <>
+    class forwarder<Key>
+    {
+    };
+    template <>
+    class forwarder<CachedKey>
+    {
+    };
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual int id() const { return 0; }
+    };
+}
+
+namespace AnyHashUnitTests
+{
+    TEST_CASE("Require equal values have equal hashes", "[hash]")
+    {
+        std::hash<Key> hasher;
+        REQUIRE(hasher(Key(42)) == hasher(Key(42)));
+        REQUIRE(hasher(Key(std::string("abc"))) == hasher(Key(std::string("abc"))));
+        REQUIRE(hasher(Key(std::string("abc"))) == std::hash<std::string>()("abc"));
+    }
+
+    TEST_CASE("Require any can be an unordered_map key", "[hash]")
+    {
+        std::unordered_map<Key, int> values;
+        values[Key(1)] = 1;
+        values[Key(std::string("two"))] = 2;
+        values[Key(Point(3, 3))] = 3;
+
+        REQUIRE(values.size() == 3);
+        REQUIRE(values[Key(1)] == 1);
+        REQUIRE(values[Key(std::string("two"))] == 2);
+        REQUIRE(values[Key(Point(3, 3))] == 3);
+        REQUIRE(values.find(Key(2)) == values.end());
+        REQUIRE(values.find(Key(Point(3, 4))) == values.end());
+    }
+
+    TEST_CASE("Require cached hash is calculated once", "[hash]")
+    {
+        const CachedKey key(Point(1, 2));
+        Point::hashes = 0;
+        std::hash<CachedKey> hasher;
+        const std::size_t first = hasher(key);
+        REQUIRE(hasher(key) == first);
+        REQUIRE(hasher(key) == first);
+        REQUIRE(Point::hashes == 1);
+
+        // copies keep the cached hash
+        const CachedKey copy(key);
+        REQUIRE(hasher(copy) == first);
+        REQUIRE(Point::hashes == 1);
+
+        std::unordered_set<CachedKey> keys;
+        keys.insert(key);
+        REQUIRE(keys.count(copy) == 1);
+    }
+}
+
+#endif
@@ -0,0 +1,247 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <vector>
+#include <algorithm>
+
+#if __cplusplus > 199711L
+
+namespace af = any_facade;
+
+namespace
+{
+    struct MoveInterface
+    {
+        virtual ~MoveInterface() {}
+        virtual int get() const = 0;
+    };
+
+    // an interface whose function names are common ones
+    struct Counter
+    {
+        virtual ~Counter() {}
+        virtual int get() const = 0;
+        virtual void reset() = 0;
+    };
+
+    struct CopyCounted
+    {
+        CopyCounted(int v) : value(v) {}
+        CopyCounted(int v1, int v2) : value(v1 + v2) {}
+        CopyCounted(const CopyCounted& other) : value(other.value) { ++copies; }
+        CopyCounted(CopyCounted&& other) noexcept : value(other.value) { ++moves; }
+        int value;
+        static int copies;
+        static int moves;
+        friend bool operator==(const CopyCounted& lhs, const CopyCounted& rhs)
+        {
+            return (lhs.value == rhs.value);
+        }
+        friend bool operator<(const CopyCounted& lhs, const CopyCounted& rhs)
+        {
+            return (lhs.value < rhs.value);
+        }
+    };
+    int CopyCounted::copies = 0;
+    int CopyCounted::moves = 0;
+
+    typedef af::any<MoveInterface> HeapAny;
+    typedef af::any<MoveInterface, af::less_than_equals_comparable, af::small_buffer<64> > SmallAny;
+    typedef af::any<Counter> CounterAny;
+}
+
+namespace any_facade
+{
+    template <>
+    class forwarder<HeapAny>
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const HeapAny*>(this)->content->get();
+        }
+    };
+    template <>
+    class forwarder<SmallAny>
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const SmallAny*>(this)->content->get();
+        }
+    };
+    template <>
+    class forwarder<CounterAny>
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const CounterAny*>(this)->content->get();
+        }
+        void reset()
+        {
+            static_cast<CounterAny*>(this)->content->reset();
+        }
+    };
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual int get() const
+        {
+            return static_cast<const Derived*>(this)->held.value;
+        }
+        virtual void reset()
+        {
+            static_cast<Derived*>(this)->held.value = 0;
+        }
+    };
+}
+
+namespace AnyMoveUnitTests
+{
+    TEST_CASE("Require any move operations don't throw", "[move]")
+    {
+        REQUIRE(std::is_nothrow_move_constructible<HeapAny>::value);
+        REQUIRE(std::is_nothrow_move_assignable<HeapAny>::value);
+        REQUIRE(std::is_nothrow_move_constructible<SmallAny>::value);
+        REQUIRE(std::is_nothrow_move_assignable<SmallAny>::value);
+    }
+
+    TEST_CASE("Require move construction steals content", "[move]")
+    {
+        HeapAny a(CopyCounted(42));
+        CopyCounted::copies = 0;
+        CopyCounted::moves = 0;
+        HeapAny b(std::move(a));
+        REQUIRE(a.empty());
+        REQUIRE(b.get() == 42);
+        REQUIRE(CopyCounted::copies == 0);
+        REQUIRE(CopyCounted::moves == 0);
+    }
+
+    TEST_CASE("Require move construction moves inline content", "[move]")
+    {
+        SmallAny a(CopyCounted(42));
+        CopyCounted::copies = 0;
+        CopyCounted::moves = 0;
+        SmallAny b(std::move(a));
+        REQUIRE(a.empty());
+        REQUIRE(b.get() == 42);
+        REQUIRE(CopyCounted::copies == 0);
+        REQUIRE(CopyCounted::moves == 1);
+    }
+
+    TEST_CASE("Require move assignment steals content", "[move]")
+    {
+        HeapAny a(CopyCounted(42));
+        HeapAny b(CopyCounted(666));
+        CopyCounted::copies = 0;
+        b = std::move(a);
+        REQUIRE(a.empty());
+        REQUIRE(b.get() == 42);
+        REQUIRE(CopyCounted::copies == 0);
+
+        b = std::move(b);
+        REQUIRE(b.get() == 42);
+    }
+
+    TEST_CASE("Require copy assignment copies once", "[move]")
+    {
+        HeapAny a(CopyCounted(42));
+        HeapAny b(CopyCounted(666));
+        CopyCounted::copies = 0;
+        b = a;
+        REQUIRE(a.get() == 42);
+        REQUIRE(b.get() == 42);
+        REQUIRE(CopyCounted::copies == 1);
+
+        SmallAny c(CopyCounted(42));
+        SmallAny d(CopyCounted(666));
+        CopyCounted::copies = 0;
+        d = c;
+        REQUIRE(d.get() == 42);
+        REQUIRE(CopyCounted::copies == 1);
+    }
+
+    TEST_CASE("Require construction from a temporary moves", "[move]")
+    {
+        CopyCounted::copies = 0;
+        CopyCounted::moves = 0;
+        HeapAny a(CopyCounted(42));
+        REQUIRE(a.get() == 42);
+        REQUIRE(CopyCounted::copies == 0);
+        REQUIRE(CopyCounted::moves == 1);
+    }
+
+    TEST_CASE("Require in place construction doesn't copy or move", "[move]")
+    {
+        CopyCounted::copies = 0;
+        CopyCounted::moves = 0;
+        HeapAny a(af::in_place_type_t<CopyCounted>(), 40, 2);
+        SmallAny b(af::in_place_type_t<CopyCounted>(), 42);
+        REQUIRE(a.get() == 42);
+        REQUIRE(b.get() == 42);
+#if __cplusplus >= 201402L
+        HeapAny c(af::in_place_type<CopyCounted>, 42);
+        REQUIRE(c.get() == 42);
+#endif
+        REQUIRE(CopyCounted::copies == 0);
+        REQUIRE(CopyCounted::moves == 0);
+    }
+
+    TEST_CASE("Require emplace replaces content in place", "[move]")
+    {
+        HeapAny a(CopyCounted(1));
+        SmallAny b;
+        CopyCounted::copies = 0;
+        CopyCounted::moves = 0;
+        a.emplace<CopyCounted>(40, 2);
+        b.emplace<CopyCounted>(666);
+        REQUIRE(a.get() == 42);
+        REQUIRE(b.get() == 666);
+        REQUIRE(CopyCounted::copies == 0);
+        REQUIRE(CopyCounted::moves == 0);
+    }
+
+    TEST_CASE("Require vector growth and reordering don't copy", "[move]")
+    {
+        std::vector<HeapAny> v;
+        for( int i = 0; i < 100; ++i )
+        {
+            v.push_back(HeapAny(CopyCounted(100 - i)));
+        }
+        CopyCounted::copies = 0;
+        v.reserve(v.capacity() * 2);
+        std::reverse(v.begin(), v.end());
+        REQUIRE(CopyCounted::copies == 0);
+        REQUIRE(v.front().get() == 1);
+        REQUIRE(v.back().get() == 100);
+
+        std::vector<SmallAny> s;
+        for( int i = 0; i < 100; ++i )
+        {
+            s.push_back(SmallAny(CopyCounted(100 - i)));
+        }
+        CopyCounted::copies = 0;
+        s.reserve(s.capacity() * 2);
+        std::reverse(s.begin(), s.end());
+        REQUIRE(CopyCounted::copies == 0);
+        REQUIRE(s.front().get() == 1);
+        REQUIRE(s.back().get() == 100);
+    }
+
+    TEST_CASE("Require forwarders can have the same names as any's implementation", "[move]")
+    {
+        CounterAny a(CopyCounted(42));
+        CounterAny b(std::move(a));
+        b.reset();
+        REQUIRE(b.get() == 0);
+        a = CounterAny(CopyCounted(666));
+        a.swap(b);
+        REQUIRE(a.get() == 0);
+        REQUIRE(b.get() == 666);
+    }
+}
+
+#endif
@@ -411,6 +411,14 @@ namespace AnyMultipleInterfacesUnitTests
         std::pair<CellId,Any> data;
     };
 
+#if __cplusplus > 199711L
+    TEST_CASE("Require holders only have a vptr for each listed interface", "[any]")
+    {
+        REQUIRE(sizeof(CellId::holder<void*>) == sizeof(void*) + sizeof(af::type_info<CellId>) + sizeof(void*));
+        REQUIRE(sizeof(Any::holder<StringCell>) == 2 * sizeof(void*) + sizeof(af::type_info<Any>) + sizeof(StringCell));
+    }
+#endif
+
     TEST_CASE("Require 'spreadsheet' operations work", "[any]")
     {
         std::map<CellId,Any> data;
@@ -0,0 +1,221 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <vector>
+#include <thread>
+
+#if __cplusplus > 199711L
+
+namespace af = any_facade;
+
+namespace
+{
+    struct PoolInterface
+    {
+        virtual ~PoolInterface() {}
+        virtual int get() const = 0;
+        virtual const void* address() const = 0;
+    };
+
+    struct SmallCell
+    {
+        SmallCell(int v) : value(v) {}
+        int value;
+        friend bool operator==(const SmallCell& lhs, const SmallCell& rhs) { return lhs.value == rhs.value; }
+        friend bool operator<(const SmallCell& lhs, const SmallCell& rhs) { return lhs.value < rhs.value; }
+    };
+
+    struct OtherSmallCell
+    {
+        OtherSmallCell(int v) : value(v) {}
+        int value;
+        friend bool operator==(const OtherSmallCell& lhs, const OtherSmallCell& rhs) { return lhs.value == rhs.value; }
+        friend bool operator<(const OtherSmallCell& lhs, const OtherSmallCell& rhs) { return lhs.value < rhs.value; }
+    };
+
+    struct alignas(64) AlignedCell
+    {
+        AlignedCell(int v) : value(v) {}
+        int value;
+        friend bool operator==(const AlignedCell& lhs, const AlignedCell& rhs) { return lhs.value == rhs.value; }
+        friend bool operator<(const AlignedCell& lhs, const AlignedCell& rhs) { return lhs.value < rhs.value; }
+    };
+
+    // the same size class as SmallCell's holder, but larger
+    struct LargerCell
+    {
+        LargerCell(int v) : value(v), padding1(0), padding2(0), padding3(0) {}
+        int value;
+        int padding1;
+        int padding2;
+        int padding3;
+        friend bool operator==(const LargerCell& lhs, const LargerCell& rhs) { return lhs.value == rhs.value; }
+        friend bool operator<(const LargerCell& lhs, const LargerCell& rhs) { return lhs.value < rhs.value; }
+    };
+
+    typedef af::any<PoolInterface, af::less_than_equals_comparable, af::pooled_storage> PooledAny;
+}
+
+namespace any_facade
+{
+    template <>
+    class forwarder<PooledAny>
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const PooledAny*>(this)->content->get();
+        }
+        const void* address() const
+        {
+            return static_cast<const PooledAny*>(this)->content->address();
+        }
+    };
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual int get() const
+        {
+            return static_cast<const Derived*>(this)->held.value;
+        }
+        virtual const void* address() const
+        {
+            return static_cast<const Derived*>(this);
+        }
+    };
+}
+
+namespace
+{
+    // made before a thread's pool, so destroyed after it
+    struct LateAllocation
+    {
+        LateAllocation() : handed(0) {}
+        ~LateAllocation()
+        {
+            handed->push_back(PooledAny(SmallCell(42)));
+        }
+        std::vector<PooledAny>* handed;
+    };
+}
+
+namespace AnyPoolUnitTests
+{
+    TEST_CASE("Require pooled holder memory is reused", "[pool]")
+    {
+        const void* first = 0;
+        {
+            PooledAny a(SmallCell(42));
+            REQUIRE(a.get() == 42);
+            first = a.address();
+        }
+        PooledAny b(SmallCell(666));
+        REQUIRE(b.get() == 666);
+        REQUIRE(b.address() == first);
+    }
+
+    TEST_CASE("Require pooled memory is shared by types of the same size", "[pool]")
+    {
+        const void* first = 0;
+        {
+            PooledAny a(SmallCell(42));
+            first = a.address();
+        }
+        PooledAny b(OtherSmallCell(666));
+        REQUIRE(b.get() == 666);
+        REQUIRE(b.address() == first);
+    }
+
+#ifdef __cpp_aligned_new
+    TEST_CASE("Require over-aligned values bypass the pool", "[pool]")
+    {
+        std::vector<PooledAny> v;
+        for( int i = 0; i < 16; ++i )
+        {
+            v.push_back(PooledAny(AlignedCell(i)));
+        }
+        for( int i = 0; i < 16; ++i )
+        {
+            REQUIRE(reinterpret_cast<std::size_t>(v[i].address()) % 64 == 0);
+            REQUIRE(v[i].get() == i);
+        }
+    }
+#endif
+
+    TEST_CASE("Require pooled clones and moves", "[pool]")
+    {
+        std::vector<PooledAny> v;
+        for( int i = 0; i < 1000; ++i )
+        {
+            v.push_back(PooledAny(SmallCell(i)));
+        }
+        std::vector<PooledAny> copy(v);
+        v.clear();
+        PooledAny moved(std::move(copy.back()));
+        REQUIRE(moved.get() == 999);
+        REQUIRE(copy[500].get() == 500);
+        REQUIRE(copy[500] == PooledAny(SmallCell(500)));
+    }
+
+    TEST_CASE("Require pools work across threads", "[pool]")
+    {
+        std::vector<std::thread> threads;
+        std::vector<int> totals(4, 0);
+        for( int t = 0; t < 4; ++t )
+        {
+            threads.push_back(std::thread([t, &totals]()
+            {
+                for( int i = 0; i < 1000; ++i )
+                {
+                    PooledAny a((SmallCell(i)));
+                    PooledAny b(a);
+                    totals[t] += b.get();
+                }
+            }));
+        }
+        // freed on this thread, allocated on another
+        std::vector<PooledAny> handed;
+        std::thread producer([&handed]()
+        {
+            for( int i = 0; i < 100; ++i )
+            {
+                handed.push_back(PooledAny(SmallCell(i)));
+            }
+        });
+        producer.join();
+        for( std::size_t t = 0; t < threads.size(); ++t )
+        {
+            threads[t].join();
+            REQUIRE(totals[t] == 999 * 1000 / 2);
+        }
+        REQUIRE(handed[99].get() == 99);
+        handed.clear();
+    }
+
+    TEST_CASE("Require blocks allocated after a thread's pool has gone can be pooled", "[pool]")
+    {
+        std::vector<PooledAny> handed;
+        handed.reserve(1);
+        std::thread producer([&handed]()
+        {
+            static thread_local LateAllocation late;
+            late.handed = &handed;
+            PooledAny a((SmallCell(1)));
+        });
+        producer.join();
+        REQUIRE(handed[0].get() == 42);
+        // its block joins the consumer's empty list and is reused for a larger holder
+        int result = 0;
+        std::thread consumer([&handed, &result]()
+        {
+            handed.clear();
+            PooledAny b((LargerCell(666)));
+            result = b.get();
+        });
+        consumer.join();
+        REQUIRE(result == 666);
+    }
+}
+
+#endif
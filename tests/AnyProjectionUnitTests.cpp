@@ -0,0 +1,241 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <map>
+#include <sstream>
+#include <string>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+namespace af = any_facade;
+
+namespace
+{
+    struct Cell
+    {
+        virtual ~Cell() {}
+        virtual void displayCellLocation(std::ostream&) const = 0;
+    };
+
+    static const int cellsPerRow = 16;
+
+    struct CoordinateCellId
+    {
+        CoordinateCellId(int x, int y) : m_index(y * cellsPerRow + x) {}
+        int m_index;
+        static int comparisons;
+        friend bool operator<(const CoordinateCellId& lhs, const CoordinateCellId& rhs)
+        {
+            ++comparisons;
+            return (lhs.m_index < rhs.m_index);
+        }
+        friend bool operator==(const CoordinateCellId& lhs, const CoordinateCellId& rhs)
+        {
+            ++comparisons;
+            return (lhs.m_index == rhs.m_index);
+        }
+    };
+    int CoordinateCellId::comparisons = 0;
+
+    struct LegacyCellId
+    {
+        LegacyCellId(int index) : m_key(index) {}
+        int key() const { return m_key; }
+        static int comparisons;
+        friend bool operator<(const LegacyCellId& lhs, const LegacyCellId& rhs)
+        {
+            ++comparisons;
+            return (lhs.m_key < rhs.m_key);
+        }
+        friend bool operator==(const LegacyCellId& lhs, const LegacyCellId& rhs)
+        {
+            ++comparisons;
+            return (lhs.m_key == rhs.m_key);
+        }
+    private:
+        int m_key;
+    };
+    int LegacyCellId::comparisons = 0;
+
+    // several people can share a surname, which is the key
+    struct Person
+    {
+        Person(const std::string& first, const std::string& last) : first(first), last(last) {}
+        std::string first;
+        std::string last;
+        static int comparisons;
+        friend bool operator<(const Person& lhs, const Person& rhs)
+        {
+            ++comparisons;
+            return (lhs.last < rhs.last) || (lhs.last == rhs.last && lhs.first < rhs.first);
+        }
+        friend bool operator==(const Person& lhs, const Person& rhs)
+        {
+            ++comparisons;
+            return (lhs.last == rhs.last && lhs.first == rhs.first);
+        }
+    };
+    int Person::comparisons = 0;
+
+    struct Named
+    {
+        virtual ~Named() {}
+    };
+
+    typedef af::any<af::interfaces<Cell>, af::projected_key<int> > CellId;
+    typedef af::any<af::interfaces<Named>, af::projected_key<std::string> > ByName;
+#if __cplusplus >= 201703L
+    typedef af::any<af::interfaces<Named>, af::projected_key<std::string_view> > ByView;
+#endif
+}
+
+namespace any_facade
+{
+    // both kinds of cell id reduce to the index
+    template <>
+    template <>
+    int projected_key<int>::key<CoordinateCellId>(const CoordinateCellId& id)
+    {
+        return id.m_index;
+    }
+    template <>
+    template <>
+    int projected_key<int>::key<LegacyCellId>(const LegacyCellId& id)
+    {
+        return id.key();
+    }
+    template <>
+    template <>
+    std::string projected_key<std::string>::key<Person>(const Person& p)
+    {
+        return p.last;
+    }
+
+    template <>
+    class forwarder<CellId>
+    {
+    public:
+        void displayCellLocation(std::ostream& os) const
+        {
+            static_cast<const CellId*>(this)->content->displayCellLocation(os);
+        }
+    };
+    template <>
+    class forwarder<ByName>
+    {
+    };
+#if __cplusplus >= 201703L
+    template <>
+    class forwarder<ByView>
+    {
+    };
+#endif
+
+    template <typename Derived, typename Base>
+    class value_type_operations<Derived, Base, CoordinateCellId> : public Base
+    {
+    public:
+        virtual void displayCellLocation(std::ostream& os) const
+        {
+            const CoordinateCellId& id = static_cast<const Derived*>(this)->value();
+            os << (id.m_index % cellsPerRow) << "," << (id.m_index / cellsPerRow);
+        }
+    };
+    template <typename Derived, typename Base>
+    class value_type_operations<Derived, Base, LegacyCellId> : public Base
+    {
+    public:
+        virtual void displayCellLocation(std::ostream& os) const
+        {
+            os << "[" << static_cast<const Derived*>(this)->value().key() << "]";
+        }
+    };
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    };
+}
+
+namespace AnyProjectionUnitTests
+{
+    TEST_CASE("Require mixed cell ids are ordered by their projected index", "[projection]")
+    {
+        std::map<CellId, int> cells;
+        cells[LegacyCellId(3)] = 3;
+        cells[CoordinateCellId(10, 2)] = 42;
+        cells[LegacyCellId(1)] = 1;
+        cells[CoordinateCellId(2, 0)] = 2;
+
+        std::ostringstream oss;
+        for( std::map<CellId, int>::const_iterator it = cells.begin(); it != cells.end(); ++it )
+        {
+            it->first.displayCellLocation(oss);
+            oss << "#";
+        }
+        REQUIRE(oss.str() == "[1]#2,0#[3]#10,2#");
+
+        CoordinateCellId::comparisons = 0;
+        LegacyCellId::comparisons = 0;
+        REQUIRE(cells.find(CoordinateCellId(10, 2))->second == 42);
+        REQUIRE(cells.find(LegacyCellId(2)) == cells.end());
+        REQUIRE(cells.find(LegacyCellId(7)) == cells.end());
+        // same index, different type
+        REQUIRE(cells.find(CoordinateCellId(1, 0)) == cells.end());
+
+        // only probes of the matching entry need a value comparison
+        REQUIRE(CoordinateCellId::comparisons <= 2);
+        REQUIRE(LegacyCellId::comparisons == 0);
+    }
+
+    TEST_CASE("Require equality compares keys before values", "[projection]")
+    {
+        LegacyCellId::comparisons = 0;
+        REQUIRE(CellId(LegacyCellId(1)) != CellId(LegacyCellId(2)));
+        REQUIRE(LegacyCellId::comparisons == 0);
+
+        REQUIRE(CellId(LegacyCellId(1)) == CellId(LegacyCellId(1)));
+        REQUIRE(LegacyCellId::comparisons == 1);
+
+        // the same key held as different types isn't equal
+        REQUIRE(CellId(LegacyCellId(2)) != CellId(CoordinateCellId(2, 0)));
+        REQUIRE((CellId(LegacyCellId(2)) < CellId(CoordinateCellId(2, 0))) != (CellId(CoordinateCellId(2, 0)) < CellId(LegacyCellId(2))));
+    }
+
+    TEST_CASE("Require equal keys fall back to comparing values", "[projection]")
+    {
+        std::map<ByName, int> people;
+        people[Person("Grace", "Hopper")] = 1;
+        people[Person("Ada", "Lovelace")] = 2;
+        people[Person("Alan", "Turing")] = 3;
+        people[Person("Byron", "Lovelace")] = 4;
+
+        REQUIRE(people.size() == 4);
+
+        Person::comparisons = 0;
+        REQUIRE(people.find(Person("Alan", "Turing"))->second == 3);
+        REQUIRE(people.find(Person("Byron", "Lovelace"))->second == 4);
+        REQUIRE(people.find(Person("Ada", "Lovelace"))->second == 2);
+        REQUIRE(people.find(Person("Ada", "Hopper")) == people.end());
+        REQUIRE(Person::comparisons > 0);
+
+        // names that aren't shared only compare keys
+        Person::comparisons = 0;
+        REQUIRE(ByName(Person("Alan", "Turing")) != ByName(Person("Grace", "Hopper")));
+        REQUIRE(ByName(Person("Alan", "Turing")) > ByName(Person("Grace", "Hopper")));
+        REQUIRE(Person::comparisons == 0);
+    }
+
+#if __cplusplus >= 201703L
+    TEST_CASE("Require copies project keys from their own value", "[projection]")
+    {
+        ByView copy = ByView(std::string(64, 'b'));
+        {
+            const ByView original(std::string(64, 'a'));
+            copy = original;
+        }
+        // the key mustn't refer into the destroyed original
+        REQUIRE(copy == ByView(std::string(64, 'a')));
+        REQUIRE(copy < ByView(std::string(64, 'b')));
+    }
+#endif
+}
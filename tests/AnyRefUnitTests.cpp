@@ -0,0 +1,172 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <vector>
+
+namespace af = any_facade;
+
+namespace
+{
+    struct Printable
+    {
+        virtual ~Printable() {}
+        virtual void print(std::ostream& os) const = 0;
+    };
+
+    struct Counter
+    {
+        virtual ~Counter() {}
+        virtual void increment(int by) = 0;
+        virtual int count() const = 0;
+    };
+
+    struct Tally
+    {
+        Tally(int v) : value(v) {}
+        Tally(const Tally& other) : value(other.value) { ++copies; }
+        int value;
+        static int copies;
+    };
+    int Tally::copies = 0;
+
+    typedef af::interfaces<Printable, Counter> Interfaces;
+    typedef af::any_ref<Interfaces> Ref;
+    typedef af::any<Interfaces, af::not_comparable> Any;
+}
+
+namespace any_facade
+{
+    template <>
+    class forwarder<Ref> : public Printable
+    {
+    public:
+        void print(std::ostream& os) const
+        {
+            static_cast<const Ref*>(this)->content->print(os);
+        }
+    };
+
+    template <>
+    class forwarder<Any> : public Printable
+    {
+    public:
+        void print(std::ostream& os) const
+        {
+            static_cast<const Any*>(this)->content->print(os);
+        }
+    };
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual void print(std::ostream& os) const
+        {
+            os << static_cast<const Derived*>(this)->held;
+        }
+        virtual void increment(int by)
+        {
+            static_cast<Derived*>(this)->held += by;
+        }
+        virtual int count() const
+        {
+            return static_cast<int>(static_cast<const Derived*>(this)->held);
+        }
+    };
+
+    template <typename Derived, typename Base>
+    class value_type_operations<Derived, Base, Tally> : public Base
+    {
+    public:
+        virtual void print(std::ostream& os) const
+        {
+            os << "Tally:" << static_cast<const Derived*>(this)->held.value;
+        }
+        virtual void increment(int by)
+        {
+            static_cast<Derived*>(this)->held.value += by;
+        }
+        virtual int count() const
+        {
+            return static_cast<const Derived*>(this)->held.value;
+        }
+    };
+}
+
+namespace AnyRefUnitTests
+{
+    int total(Ref r)
+    {
+        return r.call(&Counter::count);
+    }
+
+    TEST_CASE("Require default any_ref is empty", "[any_ref]")
+    {
+        Ref r;
+        REQUIRE(r.empty());
+    }
+
+    TEST_CASE("Require any_ref forwards to the referenced value", "[any_ref]")
+    {
+        int i = 42;
+        Ref r(i);
+        REQUIRE(!r.empty());
+        std::ostringstream oss;
+        r.print(oss);
+        REQUIRE(oss.str() == "42");
+        REQUIRE(r.call(&Counter::count) == 42);
+    }
+
+    TEST_CASE("Require any_ref doesn't copy the value", "[any_ref]")
+    {
+        Tally t(1);
+        Tally::copies = 0;
+        Ref r(t);
+        r.call(&Counter::increment, 41);
+        REQUIRE(t.value == 42);
+        REQUIRE(total(r) == 42);
+        REQUIRE(total(t) == 42);
+        REQUIRE(Tally::copies == 0);
+    }
+
+    TEST_CASE("Require any_ref refers to the content of an any", "[any_ref]")
+    {
+        Any a(Tally(1));
+        Tally::copies = 0;
+        Ref r(a);
+        r.call(&Counter::increment, 1);
+        std::ostringstream oss;
+        a.print(oss);
+        REQUIRE(oss.str() == "Tally:2");
+        REQUIRE(total(a) == 2);
+        REQUIRE(Tally::copies == 0);
+    }
+
+    TEST_CASE("Require copied any_ref refers to the same value", "[any_ref]")
+    {
+        int i = 1;
+        double d = 2.5;
+        Ref r1(i);
+        Ref r2(r1);
+        Ref r3;
+        r3 = r2;
+        r3.call(&Counter::increment, 1);
+        REQUIRE(i == 2);
+        REQUIRE(r1.call(&Counter::count) == 2);
+
+        r1 = Ref(d);
+        std::ostringstream oss;
+        r1.print(oss);
+        REQUIRE(oss.str() == "2.5");
+
+        std::vector<Ref> refs;
+        refs.push_back(r1);
+        refs.push_back(r2);
+        oss.str("");
+        for( std::vector<Ref>::const_iterator it = refs.begin(); it != refs.end(); ++it )
+        {
+            it->print(oss);
+            oss << "#";
+        }
+        REQUIRE(oss.str() == "2.5#2#");
+    }
+}
@@ -0,0 +1,167 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#if __cplusplus > 199711L
+
+namespace af = any_facade;
+
+namespace
+{
+    struct TextInterface
+    {
+        virtual ~TextInterface() {}
+        virtual std::size_t size() const = 0;
+        virtual void append(const std::string& s) = 0;
+    };
+
+    struct Text
+    {
+        Text(const std::string& s) : value(s) {}
+        Text(const Text& other) : value(other.value) { ++copies; }
+        std::string value;
+        static int copies;
+        friend bool operator==(const Text& lhs, const Text& rhs)
+        {
+            return (lhs.value == rhs.value);
+        }
+        friend bool operator<(const Text& lhs, const Text& rhs)
+        {
+            return (lhs.value < rhs.value);
+        }
+    };
+    int Text::copies = 0;
+
+    typedef af::shared_any<TextInterface> SharedAny;
+}
+
+namespace any_facade
+{
+    template <>
+    class forwarder<SharedAny>
+    {
+    public:
+        std::size_t size() const
+        {
+            return static_cast<const SharedAny*>(this)->content->size();
+        }
+        void append(const std::string& s)
+        {
+            static_cast<SharedAny*>(this)->content->append(s);
+        }
+    };
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual std::size_t size() const
+        {
+            return static_cast<const Derived*>(this)->held.value.size();
+        }
+        virtual void append(const std::string& s)
+        {
+            static_cast<Derived*>(this)->held.value += s;
+        }
+    };
+}
+
+namespace AnySharedUnitTests
+{
+    TEST_CASE("Require shared_any copies share the holder", "[shared]")
+    {
+        SharedAny a(Text("abc"));
+        REQUIRE(a.use_count() == 1);
+
+        Text::copies = 0;
+        SharedAny b(a);
+        SharedAny c;
+        c = b;
+        REQUIRE(Text::copies == 0);
+        REQUIRE(a.use_count() == 3);
+        REQUIRE(a == c);
+
+        // const calls read the shared holder
+        REQUIRE(static_cast<const SharedAny&>(b).size() == 3);
+        REQUIRE(Text::copies == 0);
+        REQUIRE(a.use_count() == 3);
+    }
+
+    TEST_CASE("Require shared_any copies on write", "[shared]")
+    {
+        SharedAny a(Text("abc"));
+        SharedAny b(a);
+
+        Text::copies = 0;
+        b.append("def");
+        REQUIRE(Text::copies == 1);
+        REQUIRE(a.use_count() == 1);
+        REQUIRE(b.use_count() == 1);
+        REQUIRE(a.size() == 3);
+        REQUIRE(b.size() == 6);
+        REQUIRE(a < b);
+
+        // b isn't shared any more, so no further copies
+        b.append("ghi");
+        REQUIRE(Text::copies == 1);
+        REQUIRE(b.size() == 9);
+    }
+
+    TEST_CASE("Require shared_any call copies on write", "[shared]")
+    {
+        SharedAny a(Text("abc"));
+        SharedAny b(a);
+
+        b.call(&TextInterface::append, std::string("d"));
+        REQUIRE(a.size() == 3);
+        REQUIRE(b.size() == 4);
+    }
+
+    TEST_CASE("Require shared_any move and emplace", "[shared]")
+    {
+        SharedAny a(Text("abc"));
+        SharedAny b(std::move(a));
+        REQUIRE(a.empty());
+        REQUIRE(a.use_count() == 0);
+        REQUIRE(b.use_count() == 1);
+
+        b.emplace<Text>("ab");
+        REQUIRE(b.size() == 2);
+    }
+
+    TEST_CASE("Require shared_any copies can be read across threads", "[shared]")
+    {
+        SharedAny a(Text(std::string(1000, 'x')));
+        Text::copies = 0;
+        std::atomic<int> failures(0);
+
+        // Catch isn't thread safe, so count failures and check them afterwards
+        std::vector<std::thread> threads;
+        for( int i = 0; i < 4; ++i )
+        {
+            threads.push_back(std::thread([&a, &failures]()
+            {
+                for( int j = 0; j < 1000; ++j )
+                {
+                    const SharedAny copy(a);
+                    if( copy.size() != 1000 )
+                    {
+                        ++failures;
+                    }
+                }
+            }));
+        }
+        for( std::size_t i = 0; i < threads.size(); ++i )
+        {
+            threads[i].join();
+        }
+        REQUIRE(failures == 0);
+        REQUIRE(Text::copies == 0);
+        REQUIRE(a.use_count() == 1);
+    }
+}
+
+#endif
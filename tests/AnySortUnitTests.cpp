@@ -0,0 +1,261 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#if __cplusplus > 199711L
+
+namespace af = any_facade;
+
+namespace
+{
+    struct Record
+    {
+        virtual ~Record() {}
+    };
+
+    struct Serial
+    {
+        Serial(int n) : n(n) {}
+        int n;
+        friend bool operator<(const Serial& lhs, const Serial& rhs) { return lhs.n < rhs.n; }
+        friend bool operator==(const Serial& lhs, const Serial& rhs) { return lhs.n == rhs.n; }
+    };
+
+    struct Metres
+    {
+        explicit Metres(double v) : value(v) {}
+        double value;
+        friend bool operator<(const Metres& lhs, const Metres& rhs) { return lhs.value < rhs.value; }
+        friend bool operator==(const Metres& lhs, const Metres& rhs) { return lhs.value == rhs.value; }
+    };
+    struct Feet
+    {
+        explicit Feet(double v) : value(v) {}
+        double value;
+        friend bool operator<(const Feet& lhs, const Feet& rhs) { return lhs.value < rhs.value; }
+        friend bool operator==(const Feet& lhs, const Feet& rhs) { return lhs.value == rhs.value; }
+    };
+
+    // ordered by number between the two types, like CoordinateCellId and
+    // LegacyCellId, so they can't be sorted one type at a time
+    struct Version
+    {
+        explicit Version(int n) : n(n) {}
+        int n;
+        friend bool operator<(const Version& lhs, const Version& rhs) { return lhs.n < rhs.n; }
+        friend bool operator==(const Version& lhs, const Version& rhs) { return lhs.n == rhs.n; }
+    };
+    struct LegacyVersion
+    {
+        explicit LegacyVersion(int n) : n(n) {}
+        int n;
+        friend bool operator<(const LegacyVersion& lhs, const LegacyVersion& rhs) { return lhs.n < rhs.n; }
+        friend bool operator==(const LegacyVersion& lhs, const LegacyVersion& rhs) { return lhs.n == rhs.n; }
+    };
+
+    bool less(const Metres& lhs, const Feet& rhs) { return lhs.value < rhs.value * 0.3048; }
+    bool less(const Feet& lhs, const Metres& rhs) { return lhs.value * 0.3048 < rhs.value; }
+
+    // counts the virtual comparisons made by std::sort
+    int virtualLess = 0;
+
+    typedef af::any<Record, af::type_ordered<af::less_than_equals_comparable> > Any;
+    typedef af::any<Record, af::type_ordered<af::three_way_comparable> > ThreeWayAny;
+    typedef af::any<Record, af::type_ordered<af::cross_type_comparable<af::less_than_comparable> > > LengthAny;
+    typedef af::any<Record> VersionAny;
+    typedef af::unique_any<Record, af::type_ordered<af::less_than_equals_comparable> > UniqueAny;
+    typedef af::shared_any<Record, af::type_ordered<af::less_than_equals_comparable> > SharedAny;
+}
+
+namespace any_facade
+{
+    template <>
+    class forwarder<Any>
+    {
+    };
+    template <>
+    class forwarder<ThreeWayAny>
+    {
+    };
+    template <>
+    class forwarder<LengthAny>
+    {
+    };
+    template <>
+    class forwarder<VersionAny>
+    {
+    };
+    template <>
+    class forwarder<UniqueAny>
+    {
+    };
+    template <>
+    class forwarder<SharedAny>
+    {
+    };
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        typedef typename Base::PlaceholderType PlaceholderType;
+        virtual bool less(const PlaceholderType& other) const
+        {
+            ++virtualLess;
+            return Base::less(other);
+        }
+    };
+
+    template <typename Derived, typename Base>
+    class value_type_operations<Derived, Base, Version> : public Base
+    {
+    public:
+        typedef typename Base::PlaceholderType PlaceholderType;
+        virtual bool less(const PlaceholderType& other) const
+        {
+            if( other.type() == type_info<typename Derived::AnyType>::template type_id<LegacyVersion>() )
+            {
+                typedef typename Derived::AnyType::template holder<LegacyVersion> OtherDerived;
+                return static_cast<const Derived*>(this)->value().n < static_cast<const OtherDerived*>(&other)->value().n;
+            }
+            return Base::less(other);
+        }
+    };
+
+    // legacy versions come first when the numbers are the same
+    template <typename Derived, typename Base>
+    class value_type_operations<Derived, Base, LegacyVersion> : public Base
+    {
+    public:
+        typedef typename Base::PlaceholderType PlaceholderType;
+        virtual bool less(const PlaceholderType& other) const
+        {
+            if( other.type() == type_info<typename Derived::AnyType>::template type_id<Version>() )
+            {
+                typedef typename Derived::AnyType::template holder<Version> OtherDerived;
+                return static_cast<const Derived*>(this)->value().n <= static_cast<const OtherDerived*>(&other)->value().n;
+            }
+            return Base::less(other);
+        }
+    };
+}
+
+namespace AnySortUnitTests
+{
+    template <typename AnyType>
+    std::vector<AnyType> records(int count)
+    {
+        std::vector<AnyType> result;
+        for( int i = 0; i < count; ++i )
+        {
+            const int n = (i * 7919) % count;
+            switch( i % 3 )
+            {
+            case 0: result.push_back(AnyType(n)); break;
+            case 1: result.push_back(AnyType(std::to_string(n))); break;
+            default: result.push_back(AnyType(Serial(n))); break;
+            }
+        }
+        return result;
+    }
+
+    // only less is registered
+    bool equivalent(const LengthAny& lhs, const LengthAny& rhs)
+    {
+        return !(lhs < rhs) && !(rhs < lhs);
+    }
+
+    TEST_CASE("Require sort_anys orders like std::sort", "[sort]")
+    {
+        std::vector<Any> expected = records<Any>(1000);
+        std::vector<Any> sorted = expected;
+        std::sort(expected.begin(), expected.end());
+
+        af::sort_anys(sorted.begin(), sorted.end());
+        REQUIRE(sorted == expected);
+
+        // already sorted, and empty
+        af::sort_anys(sorted.begin(), sorted.end());
+        REQUIRE(sorted == expected);
+        af::sort_anys(sorted.begin(), sorted.begin());
+    }
+
+    TEST_CASE("Require sort_anys doesn't make a virtual call per comparison", "[sort]")
+    {
+        std::vector<Any> values = records<Any>(1000);
+        virtualLess = 0;
+        af::sort_anys(values.begin(), values.end());
+        REQUIRE(virtualLess == 0);
+        REQUIRE(std::is_sorted(values.begin(), values.end()));
+    }
+
+    TEST_CASE("Require sort_anys works with three way comparison", "[sort]")
+    {
+        std::vector<ThreeWayAny> expected = records<ThreeWayAny>(300);
+        std::vector<ThreeWayAny> sorted = expected;
+        std::sort(expected.begin(), expected.end());
+
+        af::sort_anys(sorted.begin(), sorted.end());
+        REQUIRE(sorted == expected);
+    }
+
+    TEST_CASE("Require sort_anys sorts unique_anys and shared_anys", "[sort]")
+    {
+        std::vector<UniqueAny> expected = records<UniqueAny>(300);
+        std::vector<UniqueAny> sorted = records<UniqueAny>(300);
+        std::sort(expected.begin(), expected.end());
+        virtualLess = 0;
+        af::sort_anys(sorted.begin(), sorted.end());
+        REQUIRE(virtualLess == 0);
+        REQUIRE(sorted == expected);
+
+        std::vector<SharedAny> shared = records<SharedAny>(300);
+        std::vector<SharedAny> sharedExpected = shared;
+        std::sort(sharedExpected.begin(), sharedExpected.end());
+        af::sort_anys(shared.begin(), shared.end());
+        REQUIRE(shared == sharedExpected);
+    }
+
+    TEST_CASE("Require sort_anys orders like std::sort if less is overridden between types", "[sort]")
+    {
+        std::vector<VersionAny> expected;
+        for( int i = 0; i < 100; ++i )
+        {
+            const int n = (i * 37) % 100;
+            if( i % 2 ) expected.push_back(VersionAny(Version(n)));
+            else        expected.push_back(VersionAny(LegacyVersion(n)));
+        }
+        std::vector<VersionAny> sorted = expected;
+        std::sort(expected.begin(), expected.end());
+
+        af::sort_anys(sorted.begin(), sorted.end());
+        REQUIRE(sorted == expected);
+        REQUIRE(sorted[0] == VersionAny(LegacyVersion(0)));
+        REQUIRE(sorted[1] == VersionAny(Version(1)));
+    }
+
+    TEST_CASE("Require sort_anys honours registered cross type less", "[sort]")
+    {
+        std::vector<LengthAny> lengths;
+        lengths.push_back(LengthAny(Metres(3)));
+        lengths.push_back(LengthAny(Feet(3)));
+        lengths.push_back(LengthAny(Metres(1)));
+        lengths.push_back(LengthAny(Feet(10)));
+
+        // without a registered less the types are kept apart
+        af::sort_anys(lengths.begin(), lengths.end());
+        REQUIRE(std::is_sorted(lengths.begin(), lengths.end()));
+
+        af::binary_dispatch<LengthAny, af::less_than_comparable>::add<Metres, Feet, &less>();
+        af::binary_dispatch<LengthAny, af::less_than_comparable>::add<Feet, Metres, &less>();
+        af::sort_anys(lengths.begin(), lengths.end());
+        REQUIRE(equivalent(lengths[0], LengthAny(Feet(3))));
+        REQUIRE(equivalent(lengths[1], LengthAny(Metres(1))));
+        REQUIRE(equivalent(lengths[2], LengthAny(Metres(3))));
+        REQUIRE(equivalent(lengths[3], LengthAny(Feet(10))));
+    }
+}
+
+#endif
@@ -0,0 +1,265 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <vector>
+#include <algorithm>
+
+namespace af = any_facade;
+
+namespace
+{
+    struct StorageInterface
+    {
+        virtual ~StorageInterface() {}
+        virtual int get() const = 0;
+        virtual const void* address() const = 0;
+    };
+
+    struct LargeValue
+    {
+        LargeValue(int v) : value(v) {}
+        char padding[256];
+        int value;
+        friend bool operator==(const LargeValue& lhs, const LargeValue& rhs)
+        {
+            return (lhs.value == rhs.value);
+        }
+        friend bool operator<(const LargeValue& lhs, const LargeValue& rhs)
+        {
+            return (lhs.value < rhs.value);
+        }
+    };
+
+#if __cplusplus > 199711L
+    struct alignas(64) AlignedValue
+    {
+        AlignedValue(int v) : value(v) {}
+        int value;
+        friend bool operator==(const AlignedValue& lhs, const AlignedValue& rhs)
+        {
+            return (lhs.value == rhs.value);
+        }
+        friend bool operator<(const AlignedValue& lhs, const AlignedValue& rhs)
+        {
+            return (lhs.value < rhs.value);
+        }
+    };
+#endif
+
+    typedef af::any<StorageInterface> HeapAny;
+    typedef af::any<StorageInterface, af::less_than_equals_comparable, af::small_buffer<64> > SmallAny;
+    typedef af::any<StorageInterface, af::less_than_equals_comparable, af::small_buffer_only<64> > StrictAny;
+
+    template <typename Any>
+    bool storedInline(const Any& a)
+    {
+        const char* begin = reinterpret_cast<const char*>(&a);
+        const char* held = static_cast<const char*>(a.address());
+        return (held >= begin && held < begin + sizeof(Any));
+    }
+}
+
+namespace any_facade
+{
+    template <>
+    class forwarder<HeapAny> : public StorageInterface
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const HeapAny*>(this)->content->get();
+        }
+        const void* address() const
+        {
+            return static_cast<const HeapAny*>(this)->content->address();
+        }
+    };
+    template <>
+    class forwarder<SmallAny> : public StorageInterface
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const SmallAny*>(this)->content->get();
+        }
+        const void* address() const
+        {
+            return static_cast<const SmallAny*>(this)->content->address();
+        }
+    };
+    template <>
+    class forwarder<StrictAny> : public StorageInterface
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const StrictAny*>(this)->content->get();
+        }
+        const void* address() const
+        {
+            return static_cast<const StrictAny*>(this)->content->address();
+        }
+    };
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual int get() const
+        {
+            return static_cast<const Derived*>(this)->held;
+        }
+        virtual const void* address() const
+        {
+            return &static_cast<const Derived*>(this)->held;
+        }
+    };
+
+#if __cplusplus > 199711L
+    template <typename Derived, typename Base>
+    class value_type_operations<Derived, Base, AlignedValue> : public Base
+    {
+    public:
+        virtual int get() const
+        {
+            return static_cast<const Derived*>(this)->held.value;
+        }
+        virtual const void* address() const
+        {
+            return &static_cast<const Derived*>(this)->held;
+        }
+    };
+#endif
+
+    template <typename Derived, typename Base>
+    class value_type_operations<Derived, Base, LargeValue> : public Base
+    {
+    public:
+        virtual int get() const
+        {
+            return static_cast<const Derived*>(this)->held.value;
+        }
+        virtual const void* address() const
+        {
+            return &static_cast<const Derived*>(this)->held;
+        }
+    };
+}
+
+namespace AnyStorageUnitTests
+{
+    TEST_CASE("Require heap storage allocates small value", "[storage]")
+    {
+        HeapAny a(42);
+        REQUIRE(!storedInline(a));
+        REQUIRE(a.get() == 42);
+    }
+
+    TEST_CASE("Require small value is stored inline", "[storage]")
+    {
+        SmallAny a(42);
+        REQUIRE(storedInline(a));
+        REQUIRE(a.get() == 42);
+    }
+
+    TEST_CASE("Require large value falls back to the heap", "[storage]")
+    {
+        SmallAny a(LargeValue(42));
+        REQUIRE(!storedInline(a));
+        REQUIRE(a.get() == 42);
+    }
+
+    TEST_CASE("Require small buffer copies stay inline", "[storage]")
+    {
+        SmallAny a(42);
+        SmallAny b(a);
+        REQUIRE(storedInline(b));
+        REQUIRE(b.get() == 42);
+        REQUIRE(a == b);
+
+        SmallAny c(LargeValue(666));
+        SmallAny d(c);
+        REQUIRE(!storedInline(d));
+        REQUIRE(d.get() == 666);
+        REQUIRE(c.address() != d.address());
+    }
+
+    TEST_CASE("Require small buffer assignment and swap mix inline and heap values", "[storage]")
+    {
+        SmallAny a(42);
+        SmallAny b(LargeValue(666));
+        a.swap(b);
+        REQUIRE(a.get() == 666);
+        REQUIRE(!storedInline(a));
+        REQUIRE(b.get() == 42);
+        REQUIRE(storedInline(b));
+
+        SmallAny c;
+        c = b;
+        REQUIRE(c.get() == 42);
+        REQUIRE(storedInline(c));
+        c = a;
+        REQUIRE(c.get() == 666);
+        REQUIRE(!storedInline(c));
+
+        SmallAny empty;
+        c.swap(empty);
+        REQUIRE(c.empty());
+        REQUIRE(empty.get() == 666);
+    }
+
+    TEST_CASE("Require small buffer any can be sorted", "[storage]")
+    {
+        std::vector<SmallAny> v;
+        v.push_back(SmallAny(5));
+        v.push_back(SmallAny(LargeValue(1)));
+        v.push_back(SmallAny(3));
+        v.push_back(SmallAny(LargeValue(0)));
+        v.push_back(SmallAny(7));
+        std::sort(v.begin(), v.end());
+        std::vector<SmallAny>::iterator ints = std::find(v.begin(), v.end(), SmallAny(3));
+        REQUIRE(ints != v.end());
+        REQUIRE((ints + 1)->get() == 5);
+        REQUIRE((ints + 2)->get() == 7);
+        std::vector<SmallAny>::iterator larges = std::find(v.begin(), v.end(), SmallAny(LargeValue(0)));
+        REQUIRE(larges != v.end());
+        REQUIRE((larges + 1)->get() == 1);
+    }
+
+    TEST_CASE("Require strict small buffer stores inline", "[storage]")
+    {
+        StrictAny a(42);
+        StrictAny b(a);
+        REQUIRE(storedInline(a));
+        REQUIRE(storedInline(b));
+        REQUIRE(b.get() == 42);
+        // StrictAny c(LargeValue(42)); // doesn't compile
+    }
+
+#ifdef __cpp_aligned_new
+    TEST_CASE("Require over-aligned values are aligned on the heap", "[storage]")
+    {
+        std::vector<HeapAny> heap;
+        std::vector<SmallAny> small;
+        for( int i = 0; i < 16; ++i )
+        {
+            heap.push_back(HeapAny(AlignedValue(i)));
+            small.push_back(SmallAny(AlignedValue(i)));
+        }
+        HeapAny copy(heap.back());
+        for( int i = 0; i < 16; ++i )
+        {
+            REQUIRE(reinterpret_cast<std::size_t>(heap[i].address()) % 64 == 0);
+            REQUIRE(reinterpret_cast<std::size_t>(small[i].address()) % 64 == 0);
+            REQUIRE(small[i].get() == i);
+        }
+        REQUIRE(reinterpret_cast<std::size_t>(copy.address()) % 64 == 0);
+    }
+#endif
+
+    TEST_CASE("Require a holder has one vptr for its interface and comparisons", "[storage]")
+    {
+        // the comparisons extend the interface's vtable rather than adding their own;
+        // the holder is the vptr, the cached type id and the value
+        REQUIRE(sizeof(HeapAny::holder<void*>) == sizeof(void*) + sizeof(af::type_info<HeapAny>) + sizeof(void*));
+    }
+}
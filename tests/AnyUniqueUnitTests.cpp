@@ -0,0 +1,151 @@
+#include "catch.hpp"
+#include "any_facade.hpp"
+#include <vector>
+#include <memory>
+
+#if __cplusplus > 199711L
+
+namespace af = any_facade;
+
+namespace
+{
+    struct HandleInterface
+    {
+        virtual ~HandleInterface() {}
+        virtual int get() const = 0;
+    };
+
+    // move only, like a socket or a file handle
+    struct Handle
+    {
+        explicit Handle(int v) : value(new int(v)) {}
+        std::unique_ptr<int> value;
+        friend bool operator==(const Handle& lhs, const Handle& rhs)
+        {
+            return (*lhs.value == *rhs.value);
+        }
+        friend bool operator<(const Handle& lhs, const Handle& rhs)
+        {
+            return (*lhs.value < *rhs.value);
+        }
+    };
+
+    typedef af::unique_any<HandleInterface> UniqueAny;
+    typedef af::unique_any<HandleInterface, af::less_than_equals_comparable, af::small_buffer<> > SmallUniqueAny;
+}
+
+namespace any_facade
+{
+    template <>
+    class forwarder<UniqueAny>
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const UniqueAny*>(this)->content->get();
+        }
+    };
+    template <>
+    class forwarder<SmallUniqueAny>
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const SmallUniqueAny*>(this)->content->get();
+        }
+    };
+    template <>
+    class forwarder<any_ref<HandleInterface, not_comparable> >
+    {
+    public:
+        int get() const
+        {
+            return static_cast<const any_ref<HandleInterface, not_comparable>*>(this)->content->get();
+        }
+    };
+
+    template <typename Derived, typename Base, typename ValueType>
+    class value_type_operations : public Base
+    {
+    public:
+        virtual int get() const
+        {
+            return *static_cast<const Derived*>(this)->value().value;
+        }
+    };
+}
+
+namespace AnyUniqueUnitTests
+{
+    TEST_CASE("Require unique_any is move only", "[unique]")
+    {
+        REQUIRE(!std::is_copy_constructible<UniqueAny>::value);
+        REQUIRE(!std::is_copy_assignable<UniqueAny>::value);
+        REQUIRE(std::is_nothrow_move_constructible<UniqueAny>::value);
+        REQUIRE(std::is_nothrow_move_assignable<UniqueAny>::value);
+    }
+
+    TEST_CASE("Require unique_any holds a move only value", "[unique]")
+    {
+        UniqueAny a(Handle(1));
+        REQUIRE(a.get() == 1);
+
+        UniqueAny b(std::move(a));
+        REQUIRE(a.empty());
+        REQUIRE(b.get() == 1);
+
+        a = std::move(b);
+        REQUIRE(b.empty());
+        REQUIRE(a.get() == 1);
+    }
+
+    TEST_CASE("Require unique_any in place construction and emplace", "[unique]")
+    {
+        UniqueAny a(af::in_place_type_t<Handle>(), 2);
+        REQUIRE(a.get() == 2);
+
+        a.emplace<Handle>(3);
+        REQUIRE(a.get() == 3);
+    }
+
+    TEST_CASE("Require unique_any can be stored in a growing vector", "[unique]")
+    {
+        std::vector<UniqueAny> handles;
+        for( int i = 0; i < 100; ++i )
+        {
+            handles.push_back(UniqueAny(Handle(i)));
+        }
+        for( int i = 0; i < 100; ++i )
+        {
+            REQUIRE(handles[i].get() == i);
+        }
+    }
+
+    TEST_CASE("Require unique_any in a small buffer is moved", "[unique]")
+    {
+        std::vector<SmallUniqueAny> handles;
+        for( int i = 0; i < 100; ++i )
+        {
+            handles.push_back(SmallUniqueAny(Handle(i)));
+        }
+        for( int i = 0; i < 100; ++i )
+        {
+            REQUIRE(handles[i].get() == i);
+        }
+
+        handles[0].swap(handles[1]);
+        REQUIRE(handles[0].get() == 1);
+        REQUIRE(handles[1].get() == 0);
+        REQUIRE(handles[1] < handles[0]);
+        REQUIRE(handles[2] == SmallUniqueAny(Handle(2)));
+    }
+
+    TEST_CASE("Require any_ref can refer to a unique_any", "[unique]")
+    {
+        UniqueAny a(Handle(4));
+        af::any_ref<HandleInterface> ref(a);
+        REQUIRE(ref.get() == 4);
+    }
+}
+
+#endif
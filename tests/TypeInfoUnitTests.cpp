@@ -2,6 +2,10 @@
 
 #include "any_facade.hpp"
 #include <typeinfo>
+#include <vector>
+#if __cplusplus > 199711L
+#include <thread>
+#endif
 
 namespace TypeInfoUnitTests
 {
@@ -22,6 +26,13 @@ namespace TypeInfoUnitTests
         REQUIRE(any_facade::type_info<InterfaceClass>::type_id<A*>() == any_facade::type_info<InterfaceClass>::type_id<const A*>());
     }
 
+    TEST_CASE("Require ids are a single word", "[types]")
+    {
+        typedef int InterfaceClass; // doesn't need a real class for this test
+        // they're kept in every holder
+        REQUIRE(sizeof(any_facade::type_info<InterfaceClass>) == sizeof(void*));
+    }
+
     TEST_CASE("Require different types do not give same id", "[types]")
     {
         typedef int InterfaceClass; // doesn't need a real class for this test
@@ -67,4 +78,93 @@ namespace TypeInfoUnitTests
                                 !(any_facade::type_info<InterfaceClass>::type_id<A*>() < any_facade::type_info<InterfaceClass>::type_id<A*>());
         REQUIRE(equivalent);
     }
+
+    TEST_CASE("Require different types are strictly ordered", "[types]")
+    {
+        typedef int InterfaceClass; // doesn't need a real class for this test
+        typedef any_facade::type_info<InterfaceClass> TypeInfo;
+        std::vector<TypeInfo> ids;
+        ids.push_back(TypeInfo::type_id<int>());
+        ids.push_back(TypeInfo::type_id<long>());
+        ids.push_back(TypeInfo::type_id<double>());
+        ids.push_back(TypeInfo::type_id<A>());
+        ids.push_back(TypeInfo::type_id<A*>());
+        ids.push_back(TypeInfo::type_id<std::vector<A> >());
+        for( std::size_t i = 0; i < ids.size(); ++i )
+        {
+            for( std::size_t j = 0; j < ids.size(); ++j )
+            {
+                // exactly one of <, == and > for every pair
+                const int holds = (ids[i] < ids[j]) + (ids[i] == ids[j]) + (ids[j] < ids[i]);
+                REQUIRE(holds == 1);
+                REQUIRE((ids[i] == ids[j]) == (i == j));
+            }
+        }
+        // the same whichever interface class they're for
+        REQUIRE((TypeInfo::type_id<A>() < TypeInfo::type_id<int>()) ==
+                (any_facade::type_info<A>::type_id<A>() < any_facade::type_info<A>::type_id<int>()));
+    }
+
+#if __cplusplus > 199711L
+    // local classes can't be template arguments before C++11
+    TEST_CASE("Require types with the same name have different ids", "[types]")
+    {
+        typedef int InterfaceClass; // doesn't need a real class for this test
+        typedef any_facade::type_info<InterfaceClass> TypeInfo;
+        TypeInfo first;
+        TypeInfo second;
+        {
+            struct K { long v; };
+            first = TypeInfo::type_id<K>();
+        }
+        {
+            struct K { std::vector<A> v; };
+            second = TypeInfo::type_id<K>();
+        }
+        REQUIRE(first != second);
+        REQUIRE((first < second) != (second < first));
+    }
+
+    class B {};
+    class C {};
+
+    TEST_CASE("Require ids are the same when first used from several threads", "[types]")
+    {
+        typedef int InterfaceClass; // doesn't need a real class for this test
+        typedef any_facade::type_info<InterfaceClass> TypeInfo;
+        std::vector<size_t> bs(8), cs(8);
+        std::vector<std::thread> threads;
+        for( std::size_t i = 0; i < bs.size(); ++i )
+        {
+            threads.push_back(std::thread([i, &bs, &cs]()
+            {
+                bs[i] = TypeInfo::type_id<B>().hash_code();
+                cs[i] = TypeInfo::type_id<C>().hash_code();
+            }));
+        }
+        for( std::size_t i = 0; i < threads.size(); ++i )
+        {
+            threads[i].join();
+        }
+        for( std::size_t i = 0; i < bs.size(); ++i )
+        {
+            REQUIRE(bs[i] == TypeInfo::type_id<B>().hash_code());
+            REQUIRE(cs[i] == TypeInfo::type_id<C>().hash_code());
+        }
+        REQUIRE(TypeInfo::type_id<B>() != TypeInfo::type_id<C>());
+    }
+#endif
+
+#if __cplusplus >= 201402L && !defined(ANY_FACADE_USE_RTTI)
+    TEST_CASE("Require ids are compile time constants", "[types]")
+    {
+        typedef int InterfaceClass; // doesn't need a real class for this test
+        typedef any_facade::type_info<InterfaceClass> TypeInfo;
+        static_assert(TypeInfo::type_id<A>() == TypeInfo::type_id<const A&>(), "same type, same id");
+        static_assert(TypeInfo::type_id<A>() != TypeInfo::type_id<A*>(), "different types, different ids");
+        static_assert(TypeInfo::type_id<int>() < TypeInfo::type_id<double>() ||
+                      TypeInfo::type_id<double>() < TypeInfo::type_id<int>(), "different types are ordered");
+        REQUIRE(std::integral_constant<size_t, TypeInfo::type_id<A>().hash_code()>::value == TypeInfo::type_id<A>().hash_code());
+    }
+#endif
 }